@@ -1,15 +1,95 @@
+#if defined(_WIN32)
+#define _CRT_RAND_S        // rand_s() for seeding the token generator
+#endif
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
+#include <stdarg.h>
+#if defined(__linux__)
+#include <sys/random.h>
+#endif
 
 // Mobile OS Features
 #define MAX_PROCESSES 128
 #define MAX_SENSORS 16
 #define MAX_APP_PERMISSIONS 8
 #define SECURITY_TOKEN_LENGTH 32
+#define MAX_CPUS 4
+#define PROC_BUFFER_SIZE 2048
+#define EVENT_QUEUE_SIZE 256
+#define CPU_OPP_COUNT 4
+#define MAX_JOBS 256
+#define MAINTENANCE_WINDOW_SECONDS (15 * 60)
+
+// Virtual memory: 4 KB pages, 1024 entries per page table level
+#define PAGE_SHIFT 12
+#define PAGE_SIZE (1 << PAGE_SHIFT)
+#define PTES_PER_TABLE 1024
+#define TLB_SETS 16
+#define TLB_WAYS 4
+
+// Page Table Entry Flags
+#define PTE_PRESENT 0x001
+#define PTE_WRITABLE 0x002
+#define PTE_ACCESSED 0x004
+#define PTE_DIRTY 0x008
+#define PTE_SWAPPED 0x010   // Evicted by reclaim, the next touch is a major fault
+#define PTE_COW 0x020       // Shared read-only, copied on the first write
+
+#define ZYGOTE_PRELOAD_BASE 0x08000000
+
+// Deadline class bandwidth per CPU, in 1/DL_BANDWIDTH_UNIT of a CPU (95% like sched_rt_runtime)
+#define DL_BANDWIDTH_UNIT (1 << 20)
+#define DL_BANDWIDTH_LIMIT (DL_BANDWIDTH_UNIT / 100 * 95)
+#define MAX_MUTEX_WAITERS 16
+
+// Sensor fan-out: the 1 KB data buffer is a ring of 32-bit samples
+#define MAX_SENSOR_SUBSCRIPTIONS 64
+#define SENSOR_RING_SAMPLES (1024 / sizeof(int32_t))
+
+// Storage device model (flash, times in microseconds)
+#define IO_BACKING_FILE "mobile_os_storage.img"
+#define IO_BLOCK_SIZE 4096
+#define IO_DEVICE_BLOCKS 1024             // 4 MB backing file
+#define MAX_IO_REQUESTS 256
+#define IO_QUEUE_DEPTH 4                  // Commands the device services at once
+#define IO_MAX_MERGE_BLOCKS 32
+#define IO_COMMAND_US 50
+#define IO_SEEK_US 30                     // Extra cost when a command is not sequential
+#define IO_BLOCK_US 25
+#define IO_READ_EXPIRE_US 5000
+#define IO_WRITE_EXPIRE_US 50000
+#define IO_FOREGROUND_STREAK 16           // Foreground dispatches before waiting background gets one
+
+// Security tokens
+#define TOKEN_TABLE_SIZE 256                // Power of two, at least twice MAX_PROCESSES
+#define TOKEN_LIFETIME_SECONDS 3600
+#define CSPRNG_BATCH_BLOCKS 16              // 64 byte ChaCha20 blocks generated per refill
+#define CSPRNG_RESEED_BYTES (1024 * 1024)
+
+// Governor tuning (utilization is 0 - 1024, one tick is 1 ms)
+#define PELT_DECAY 1002                 // y * 1024, y^32 = 0.5
+#define GOVERNOR_FULL_ENTER_UTIL 640
+#define GOVERNOR_FULL_EXIT_UTIL 448
+#define GOVERNOR_SAVE_ENTER_UTIL 128
+#define GOVERNOR_SAVE_EXIT_UTIL 256
+#define GOVERNOR_HYSTERESIS_TICKS 200
+
+// Thermal model
+#define THERMAL_AMBIENT 25.0
+#define THERMAL_RESISTANCE 10.0         // Degrees C per W
+#define THERMAL_TIME_CONSTANT_TICKS 1000.0
+#define THERMAL_TRIP 80.0
+#define THERMAL_RELEASE 70.0
+#define THERMAL_STEP_TICKS 100
+
+// Latency histograms: 8 linear sub-buckets per power of two (HDR-style, ~12% precision)
+#define HIST_SUB_BUCKET_BITS 3
+#define HIST_SUB_BUCKETS (1 << HIST_SUB_BUCKET_BITS)
+#define HIST_BUCKETS (40 * HIST_SUB_BUCKETS)
 
 // Power Management States
 typedef enum {
@@ -43,14 +123,58 @@ typedef enum {
     PERM_BACKGROUND_PROCESS
 } AppPermission;
 
+// Scheduling Classes, checked in this order
+typedef enum {
+    SCHED_CLASS_DEADLINE,   // EDF with runtime/period/deadline reservations
+    SCHED_CLASS_NORMAL      // Fixed priority
+} SchedulingClass;
+
+// SCHED_DEADLINE-style Reservation
+typedef struct {
+    uint32_t runtime_us;     // CPU time guaranteed per period
+    uint32_t period_us;
+    uint32_t deadline_us;    // Relative to the job release
+    uint64_t abs_deadline;   // Of the current job
+    uint32_t runtime_left;   // Throttled at 0 until the next release
+    uint64_t next_release;   // Start of the next period
+} DeadlineParams;
+
 // Sensor Data Structure
 typedef struct {
     SensorType type;
     bool is_active;
     void* data_buffer;
     uint16_t sampling_rate;
+    uint16_t base_sampling_rate; // Hardware rate given at registration
+    uint32_t samples_written;    // Total samples pushed into data_buffer
+    uint8_t subscriber_count;
 } SensorConfig;
 
+// Sensor Subscription, one per process and sensor
+typedef struct {
+    bool is_active;
+    uint32_t pid;
+    uint8_t sensor_slot;
+    uint16_t requested_rate;
+    uint32_t decimation;      // Deliver every Nth sample the sensor produces
+    uint32_t next_sample;     // Absolute index of the next sample to deliver
+} SensorSubscription;
+
+// Batch of samples handed out by reference into the sensor's shared ring
+typedef struct {
+    const int32_t* ring;
+    uint32_t start;           // Ring index of the first sample
+    uint32_t count;
+    uint32_t stride;          // Decimation factor
+} SensorBatch;
+
+// Security Token for App Authentication
+typedef struct {
+    uint8_t token[SECURITY_TOKEN_LENGTH];
+    uint32_t creation_time;
+    bool is_valid;
+} SecurityToken;
+
 // Process Control Block
 typedef struct {
     uint32_t pid;
@@ -60,15 +184,16 @@ typedef struct {
     bool permissions[MAX_APP_PERMISSIONS];
     PowerManagementState power_state;
     uint32_t last_active_timestamp;
+    uint32_t last_background_run; // Last time one of its background jobs started
+    bool is_zygote;               // Template that apps are forked from, never scheduled
+    SchedulingClass sched_class;
+    DeadlineParams dl;            // SCHED_CLASS_DEADLINE only
+    uint8_t cpu;                  // CPU the process is placed on
+    uint8_t pi_priority;          // Inherited from mutex waiters, 0 if none
+    uint64_t pi_deadline;         // Inherited from deadline waiters, 0 if none
+    SecurityToken security_token; // Presented by the app to authenticate itself
 } EnhancedProcessControlBlock;
 
-// Security Token for App Authentication
-typedef struct {
-    uint8_t token[SECURITY_TOKEN_LENGTH];
-    uint32_t creation_time;
-    bool is_valid;
-} SecurityToken;
-
 // Mobile OS Kernel State
 typedef struct {
     EnhancedProcessControlBlock processes[MAX_PROCESSES];
@@ -77,38 +202,756 @@ typedef struct {
     PowerManagementState current_power_mode;
     uint32_t total_memory;
     uint32_t available_memory;
+    uint32_t dl_bandwidth[MAX_CPUS];   // Reserved by deadline tasks
 } MobileOSKernel;
 
+// Kernel Mutex for resources shared between processes
+typedef struct {
+    uint32_t owner;
+    uint32_t waiters[MAX_MUTEX_WAITERS];
+    uint8_t waiter_count;
+    bool priority_inheritance;  // Boost the owner to its most urgent waiter
+} KernelMutex;
+
+// Metric Counters (per CPU)
+typedef enum {
+    COUNTER_PROCESSES_CREATED,
+    COUNTER_PROCESS_CREATE_FAILED,
+    COUNTER_MEMORY_ALLOCATIONS,
+    COUNTER_MEMORY_ALLOC_FAILED,
+    COUNTER_MEMORY_RECLAIMS,
+    COUNTER_POWER_TRANSITIONS,
+    COUNTER_SCHEDULER_PASSES,
+    COUNTER_CONTEXT_SWITCHES,
+    COUNTER_SENSOR_SAMPLES,
+    COUNTER_JOB_WAKEUPS,
+    COUNTER_JOBS_RUN,
+    COUNTER_TLB_HITS,
+    COUNTER_TLB_MISSES,
+    COUNTER_PAGE_FAULTS,
+    COUNTER_MAJOR_FAULTS,
+    COUNTER_PAGES_RECLAIMED,
+    COUNTER_COW_FAULTS,
+    COUNTER_IO_REQUESTS,
+    COUNTER_IO_MERGES,
+    COUNTER_IO_COMMANDS,
+    COUNTER_TOKENS_MINTED,
+    COUNTER_TOKENS_REJECTED,
+    METRIC_COUNTER_COUNT
+} MetricCounter;
+
+// Metric Gauges (system wide)
+typedef enum {
+    GAUGE_AVAILABLE_MEMORY,
+    GAUGE_ACTIVE_SENSORS,
+    GAUGE_RUNNABLE_TASKS,
+    METRIC_GAUGE_COUNT
+} MetricGauge;
+
+// Hot-path Latency Histograms
+typedef enum {
+    HIST_MEMORY_ALLOCATION,
+    HIST_PROCESS_CREATE,
+    HIST_POWER_MANAGEMENT,
+    HIST_SCHEDULER_PASS,
+    HIST_PAGE_FAULT,
+    HIST_STORAGE_IO,
+    METRIC_HIST_COUNT
+} MetricHistogram;
+
+typedef struct {
+    uint64_t buckets[HIST_BUCKETS];
+    uint64_t count;
+    uint64_t sum;             // Same unit as the recorded values, ns for kernel metrics
+    uint64_t max;
+} LatencyHistogram;
+
+// Kernel Metrics Registry
+// Each CPU only writes its own slots, readers sum them, so no lock is needed
+typedef struct {
+    uint64_t counters[MAX_CPUS][METRIC_COUNTER_COUNT];
+    LatencyHistogram histograms[MAX_CPUS][METRIC_HIST_COUNT];
+    int64_t gauges[METRIC_GAUGE_COUNT];
+} KernelMetrics;
+
+// Kernel State-change Events
+typedef enum {
+    EVENT_PROCESS_CREATED,
+    EVENT_PROCESS_EXITED,
+    EVENT_PRIORITY_CHANGED,
+    EVENT_POWER_STATE_CHANGED,
+    EVENT_SENSOR_ADDED,
+    EVENT_SENSOR_RATE_CHANGED,
+    EVENT_POWER_MODE_CHANGED,
+    EVENT_RESYNC // Subscriber fell behind, rebuild from a full scan
+} KernelEventType;
+
+typedef struct {
+    KernelEventType type;
+    uint32_t sequence;
+    uint32_t id;              // PID or sensor slot
+    uint32_t value;           // Priority, power state, sampling rate or power mode
+    SensorType sensor_type;   // EVENT_SENSOR_ADDED only
+    char process_name[32];    // EVENT_PROCESS_CREATED only
+} KernelEvent;
+
+// Bounded Event Queue
+// The kernel never blocks on slow subscribers: old events are overwritten
+// and a subscriber that missed them gets EVENT_RESYNC instead
+typedef struct {
+    KernelEvent events[EVENT_QUEUE_SIZE];
+    uint32_t write_sequence; // Total events ever published
+} KernelEventQueue;
+
+// Per-subscriber read cursor
+typedef struct {
+    uint32_t read_sequence;
+} EventSubscriber;
+
+// CPU Frequency Governor Policies
+typedef enum {
+    GOVERNOR_PERFORMANCE,   // Always the highest allowed frequency
+    GOVERNOR_POWERSAVE,     // Always the lowest frequency
+    GOVERNOR_SCHEDUTIL,     // Frequency follows utilization, steps power modes
+    GOVERNOR_POLICY_COUNT
+} GovernorPolicy;
+
+// Simulated CPU Operating Point
+typedef struct {
+    uint32_t freq_mhz;
+    uint32_t active_mw;
+    uint32_t idle_mw;
+} OperatingPoint;
+
+// Governor and Thermal State
+typedef struct {
+    GovernorPolicy policy;
+    uint32_t cpu_util[MAX_CPUS];     // Decayed, frequency invariant load (0 - 1024)
+    uint8_t cpu_opp[MAX_CPUS];       // Current operating point per CPU
+    uint8_t thermal_cap;             // Highest operating point allowed by the thermal model
+    double temperature;              // Degrees C
+    uint32_t thermal_hold_ticks;
+    PowerManagementState pending_mode;
+    uint32_t mode_hold_ticks;
+    uint32_t throttled_ticks;
+    uint32_t mode_switches;
+} CpuGovernor;
+
+// Background Job Constraints (bit flags)
+typedef enum {
+    JOB_REQUIRES_CHARGING = 1 << 0,
+    JOB_REQUIRES_IDLE = 1 << 1,
+    JOB_REQUIRES_NETWORK = 1 << 2
+} JobConstraint;
+
+// App Standby Buckets, derived from how recently an app was used
+typedef enum {
+    BUCKET_ACTIVE,
+    BUCKET_WORKING_SET,
+    BUCKET_FREQUENT,
+    BUCKET_RARE,
+    BUCKET_RESTRICTED,
+    STANDBY_BUCKET_COUNT
+} StandbyBucket;
+
+// Deferred Background Job
+typedef struct {
+    uint32_t job_id;
+    uint32_t pid;
+    uint32_t earliest_time;   // Window opens
+    uint32_t deadline;        // After this the constraints are ignored
+    uint8_t constraints;
+    bool is_pending;
+} BackgroundJob;
+
+// Device state the job constraints are checked against
+typedef struct {
+    bool charging;
+    bool idle;
+    bool network;
+} DeviceConditions;
+
+// Background Job Scheduler
+typedef struct {
+    BackgroundJob jobs[MAX_JOBS];
+    uint32_t next_job_id;
+    DeviceConditions conditions;
+    bool coalesce;            // Only wake for maintenance windows and deadlines
+    uint32_t next_window;     // Start of the next maintenance window, 0 until the first run
+    uint32_t wakeups;
+    uint32_t deadline_misses; // Jobs started after their deadline
+    LatencyHistogram delays;  // Seconds from window open to job start
+} JobScheduler;
+
+// Second level page table, one entry per 4 KB page
+typedef struct {
+    uint32_t entries[PTES_PER_TABLE];   // Frame number << PAGE_SHIFT | PTE flags
+} PageTable;
+
+// Per-process Virtual Address Space (two level, 10/10/12 split of a 32-bit address)
+typedef struct {
+    PageTable* tables[PTES_PER_TABLE];
+    uint32_t resident_pages;
+} AddressSpace;
+
+// Physical Frame metadata
+typedef struct {
+    uint32_t owner_pid;
+    uint32_t vpn;              // Virtual page the owner maps it at
+    uint16_t map_count;        // 0 when the frame is free
+    bool referenced;           // Second chance bit for the reclaim clock
+    bool shared;               // Mapped copy-on-write, owner_pid/vpn may be stale
+} PhysicalFrame;
+
+// Simulated TLB entry, tagged with the pid so switches need no flush
+typedef struct {
+    bool valid;
+    bool writable;
+    uint32_t pid;
+    uint32_t vpn;
+    uint32_t pfn;
+    uint32_t last_used;
+} TlbEntry;
+
+// Virtual Memory State
+typedef struct {
+    PhysicalFrame* frames;
+    uint32_t* free_frames;     // Stack of free frame numbers
+    uint32_t frame_count;
+    uint32_t free_count;
+    uint32_t clock_hand;
+    AddressSpace spaces[MAX_PROCESSES];
+    TlbEntry tlb[TLB_SETS][TLB_WAYS];
+    uint32_t tlb_clock;
+} VirtualMemory;
+
+// Storage Request Direction
+typedef enum {
+    IO_READ,
+    IO_WRITE
+} IoDirection;
+
+// Storage Request Class, background apps queue behind foreground ones
+typedef enum {
+    IO_CLASS_FOREGROUND,
+    IO_CLASS_BACKGROUND,
+    IO_CLASS_COUNT
+} IoClass;
+
+// Storage Scheduler Policies
+typedef enum {
+    IO_SCHED_FIFO,        // Submission order, one command per request
+    IO_SCHED_DEADLINE     // Elevator with expiry deadlines and request merging
+} IoSchedulerPolicy;
+
+typedef enum {
+    IO_FREE,
+    IO_QUEUED,
+    IO_IN_FLIGHT,
+    IO_COMPLETE           // Waiting in the completion queue
+} IoRequestState;
+
+// Block I/O Request
+typedef struct {
+    IoRequestState state;
+    uint32_t id;
+    uint32_t pid;
+    IoDirection direction;
+    IoClass io_class;
+    uint32_t block;
+    uint32_t block_count;
+    uint8_t* buffer;          // Owned by the caller until the completion is reaped
+    uint64_t submit_us;
+    uint64_t expire_us;       // Past this the request jumps the elevator
+    uint64_t complete_us;
+    int32_t result;           // Bytes transferred, or -1 on error
+    int16_t next_merged;      // Next request served by the same device command, -1 if none
+} IoRequest;
+
+typedef struct {
+    uint32_t id;
+    uint32_t pid;
+    int32_t result;
+    uint64_t latency_us;
+} IoCompletion;
+
+// Storage Device backed by a local file
+typedef struct {
+    FILE* backing;
+    IoSchedulerPolicy policy;
+    IoRequest requests[MAX_IO_REQUESTS];
+    uint32_t next_id;
+    uint64_t now_us;                              // Device clock
+    int16_t channel[IO_QUEUE_DEPTH];              // First request of the command in service, -1 if idle
+    uint64_t channel_busy_until[IO_QUEUE_DEPTH];
+    uint32_t head_block;                          // Elevator position
+    uint32_t foreground_streak;                   // Foreground dispatches while background waited
+    uint16_t completions[MAX_IO_REQUESTS];        // Request slots, in completion order
+    uint32_t completion_head;
+    uint32_t completion_tail;
+} StorageDevice;
+
+// ChaCha20 based random generator, output is handed out from a batch of blocks
+typedef struct {
+    uint32_t state[16];                            // Constants, key, block counter, nonce
+    uint8_t buffer[CSPRNG_BATCH_BLOCKS * 64];
+    uint32_t available;                            // Unused bytes at the end of buffer
+    uint32_t bytes_since_reseed;
+    bool is_seeded;
+} Csprng;
+
 // Global Kernel Instance
 static MobileOSKernel mobile_kernel;
+static KernelMetrics kernel_metrics;
+static KernelEventQueue kernel_events;
+static CpuGovernor cpu_governor;
+static JobScheduler job_scheduler;
+static VirtualMemory virtual_memory;
+static SensorSubscription sensor_subscriptions[MAX_SENSOR_SUBSCRIPTIONS];
+static StorageDevice storage;
+static Csprng csprng;
+static uint16_t token_table[TOKEN_TABLE_SIZE]; // Open addressed by token, holds pids
+static uint8_t current_cpu; // CPU the simulated kernel is currently running on
+
+static const char* histogram_names[METRIC_HIST_COUNT] = {
+    "memory_allocation",
+    "process_create",
+    "power_management",
+    "scheduler_pass",
+    "page_fault",
+    "storage_io"
+};
+
+static const OperatingPoint cpu_opps[CPU_OPP_COUNT] = {
+    { 600,  150, 20},
+    {1200,  450, 30},
+    {1800, 1000, 45},
+    {2400, 1900, 60}
+};
+
+static const char* governor_names[GOVERNOR_POLICY_COUNT] = {
+    "performance",
+    "powersave",
+    "schedutil"
+};
+
+// Idle time after which an app drops into the next standby bucket
+static const uint32_t standby_bucket_idle[STANDBY_BUCKET_COUNT - 1] = {
+    10 * 60,     // Active
+    3600,        // Working set
+    8 * 3600,    // Frequent
+    24 * 3600    // Rare
+};
+
+// Minimum time between background runs in each standby bucket
+static const uint32_t standby_bucket_interval[STANDBY_BUCKET_COUNT] = {
+    0,
+    10 * 60,
+    30 * 60,
+    2 * 3600,
+    24 * 3600
+};
 
 uint32_t system_time() {
     return (uint32_t)time(NULL); // Use Unix timestamp in seconds
 }
 
+// High resolution clock for latency measurements
+uint64_t monotonic_ns() {
+    struct timespec ts;
+#if defined(CLOCK_MONOTONIC)
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+    timespec_get(&ts, TIME_UTC);
+#endif
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Kernel Metrics ----------------------------------------------------------------
+
+static inline void metrics_count(MetricCounter counter, uint64_t delta) {
+    kernel_metrics.counters[current_cpu][counter] += delta;
+}
+
+static inline void metrics_gauge_set(MetricGauge gauge, int64_t value) {
+    kernel_metrics.gauges[gauge] = value;
+}
+
+static inline void metrics_gauge_add(MetricGauge gauge, int64_t delta) {
+    kernel_metrics.gauges[gauge] += delta;
+}
+
+// Map a value onto its log-linear bucket
+static inline uint32_t histogram_bucket(uint64_t value) {
+    if (value < HIST_SUB_BUCKETS) {
+        return (uint32_t)value;
+    }
+    uint32_t shift = 63 - __builtin_clzll(value) - HIST_SUB_BUCKET_BITS;
+    uint32_t index = (shift + 1) * HIST_SUB_BUCKETS + ((value >> shift) & (HIST_SUB_BUCKETS - 1));
+    return index < HIST_BUCKETS ? index : HIST_BUCKETS - 1;
+}
+
+// Smallest value that lands in a bucket
+static uint64_t histogram_bucket_value(uint32_t index) {
+    if (index < HIST_SUB_BUCKETS) {
+        return index;
+    }
+    uint32_t shift = index / HIST_SUB_BUCKETS - 1;
+    return (uint64_t)(HIST_SUB_BUCKETS + index % HIST_SUB_BUCKETS) << shift;
+}
+
+void histogram_record(LatencyHistogram* h, uint64_t value) {
+    h->buckets[histogram_bucket(value)]++;
+    h->count++;
+    h->sum += value;
+    if (value > h->max) {
+        h->max = value;
+    }
+}
+
+void metrics_record_latency(MetricHistogram hist, uint64_t elapsed_ns) {
+    histogram_record(&kernel_metrics.histograms[current_cpu][hist], elapsed_ns);
+}
+
+uint64_t metrics_counter_total(MetricCounter counter) {
+    uint64_t total = 0;
+    for (int cpu = 0; cpu < MAX_CPUS; cpu++) {
+        total += kernel_metrics.counters[cpu][counter];
+    }
+    return total;
+}
+
+// Merge the per-CPU histograms into one snapshot
+void metrics_histogram_snapshot(MetricHistogram hist, LatencyHistogram* out) {
+    memset(out, 0, sizeof(LatencyHistogram));
+    for (int cpu = 0; cpu < MAX_CPUS; cpu++) {
+        const LatencyHistogram* h = &kernel_metrics.histograms[cpu][hist];
+        if (h->count == 0) {
+            continue;
+        }
+        for (int b = 0; b < HIST_BUCKETS; b++) {
+            out->buckets[b] += h->buckets[b];
+        }
+        out->count += h->count;
+        out->sum += h->sum;
+        if (h->max > out->max) {
+            out->max = h->max;
+        }
+    }
+}
+
+uint64_t histogram_percentile(const LatencyHistogram* h, double percentile) {
+    if (h->count == 0) {
+        return 0;
+    }
+    uint64_t target = (uint64_t)(h->count * percentile / 100.0 + 0.999999); // rank, rounded up
+    if (target == 0) {
+        target = 1;
+    }
+    uint64_t seen = 0;
+    for (uint32_t b = 0; b < HIST_BUCKETS; b++) {
+        seen += h->buckets[b];
+        if (seen >= target) {
+            uint64_t value = histogram_bucket_value(b);
+            return value < h->max ? value : h->max;
+        }
+    }
+    return h->max;
+}
+
+// Proc-style Snapshot API ---------------------------------------------------------
+
+static void proc_append(char* buffer, size_t buffer_size, size_t* offset, const char* format, ...) {
+    if (*offset >= buffer_size) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(buffer + *offset, buffer_size - *offset, format, args);
+    va_end(args);
+    if (written > 0) {
+        *offset += (size_t)written;
+        if (*offset >= buffer_size) {
+            *offset = buffer_size - 1;
+        }
+    }
+}
+
+static void proc_meminfo(char* buffer, size_t buffer_size, size_t* offset) {
+    proc_append(buffer, buffer_size, offset, "MemTotal:       %10u kB\n", mobile_kernel.total_memory / 1024);
+    proc_append(buffer, buffer_size, offset, "MemAvailable:   %10lld kB\n",
+                (long long)kernel_metrics.gauges[GAUGE_AVAILABLE_MEMORY] / 1024);
+    proc_append(buffer, buffer_size, offset, "AllocCalls:     %10llu\n",
+                (unsigned long long)metrics_counter_total(COUNTER_MEMORY_ALLOCATIONS));
+    proc_append(buffer, buffer_size, offset, "AllocFailed:    %10llu\n",
+                (unsigned long long)metrics_counter_total(COUNTER_MEMORY_ALLOC_FAILED));
+    proc_append(buffer, buffer_size, offset, "Reclaims:       %10llu\n",
+                (unsigned long long)metrics_counter_total(COUNTER_MEMORY_RECLAIMS));
+    proc_append(buffer, buffer_size, offset, "FreePages:      %10u\n", virtual_memory.free_count);
+    proc_append(buffer, buffer_size, offset, "PagesReclaimed: %10llu\n",
+                (unsigned long long)metrics_counter_total(COUNTER_PAGES_RECLAIMED));
+}
+
+static void proc_vmstat(char* buffer, size_t buffer_size, size_t* offset) {
+    uint64_t hits = metrics_counter_total(COUNTER_TLB_HITS);
+    uint64_t misses = metrics_counter_total(COUNTER_TLB_MISSES);
+
+    proc_append(buffer, buffer_size, offset, "pgfault %llu\n",
+                (unsigned long long)metrics_counter_total(COUNTER_PAGE_FAULTS));
+    proc_append(buffer, buffer_size, offset, "pgmajfault %llu\n",
+                (unsigned long long)metrics_counter_total(COUNTER_MAJOR_FAULTS));
+    proc_append(buffer, buffer_size, offset, "cow_fault %llu\n",
+                (unsigned long long)metrics_counter_total(COUNTER_COW_FAULTS));
+    proc_append(buffer, buffer_size, offset, "pgsteal %llu\n",
+                (unsigned long long)metrics_counter_total(COUNTER_PAGES_RECLAIMED));
+    proc_append(buffer, buffer_size, offset, "tlb_hit %llu tlb_miss %llu\n",
+                (unsigned long long)hits, (unsigned long long)misses);
+}
+
+static void proc_schedstat(char* buffer, size_t buffer_size, size_t* offset) {
+    for (int cpu = 0; cpu < MAX_CPUS; cpu++) {
+        proc_append(buffer, buffer_size, offset, "cpu%d passes %llu switches %llu created %llu dl_bw %u%%\n", cpu,
+                    (unsigned long long)kernel_metrics.counters[cpu][COUNTER_SCHEDULER_PASSES],
+                    (unsigned long long)kernel_metrics.counters[cpu][COUNTER_CONTEXT_SWITCHES],
+                    (unsigned long long)kernel_metrics.counters[cpu][COUNTER_PROCESSES_CREATED],
+                    (uint32_t)((uint64_t)mobile_kernel.dl_bandwidth[cpu] * 100 / DL_BANDWIDTH_UNIT));
+    }
+    proc_append(buffer, buffer_size, offset, "runnable %lld\n", (long long)kernel_metrics.gauges[GAUGE_RUNNABLE_TASKS]);
+    proc_append(buffer, buffer_size, offset, "jobs_run %llu job_wakeups %llu\n",
+                (unsigned long long)metrics_counter_total(COUNTER_JOBS_RUN),
+                (unsigned long long)metrics_counter_total(COUNTER_JOB_WAKEUPS));
+    proc_append(buffer, buffer_size, offset, "power_mode %d transitions %llu\n", mobile_kernel.current_power_mode,
+                (unsigned long long)metrics_counter_total(COUNTER_POWER_TRANSITIONS));
+}
+
+static void proc_sensorstat(char* buffer, size_t buffer_size, size_t* offset) {
+    proc_append(buffer, buffer_size, offset, "active %lld samples %llu\n",
+                (long long)kernel_metrics.gauges[GAUGE_ACTIVE_SENSORS],
+                (unsigned long long)metrics_counter_total(COUNTER_SENSOR_SAMPLES));
+    for (int i = 0; i < MAX_SENSORS; i++) {
+        if (mobile_kernel.sensors[i].is_active) {
+            proc_append(buffer, buffer_size, offset, "sensor%d type %d rate %u/%u Hz subscribers %u\n",
+                        i, mobile_kernel.sensors[i].type, mobile_kernel.sensors[i].sampling_rate,
+                        mobile_kernel.sensors[i].base_sampling_rate, mobile_kernel.sensors[i].subscriber_count);
+        }
+    }
+}
+
+static void proc_cpufreq(char* buffer, size_t buffer_size, size_t* offset) {
+    for (int cpu = 0; cpu < MAX_CPUS; cpu++) {
+        proc_append(buffer, buffer_size, offset, "cpu%d util %u freq %u MHz\n", cpu,
+                    cpu_governor.cpu_util[cpu], cpu_opps[cpu_governor.cpu_opp[cpu]].freq_mhz);
+    }
+    proc_append(buffer, buffer_size, offset, "governor %s\n", governor_names[cpu_governor.policy]);
+    proc_append(buffer, buffer_size, offset, "temperature %.1f C thermal_cap %u\n",
+                cpu_governor.temperature, cpu_governor.thermal_cap);
+}
+
+static void proc_latency(char* buffer, size_t buffer_size, size_t* offset) {
+    proc_append(buffer, buffer_size, offset, "%-18s %8s %10s %10s %10s %10s\n",
+                "path", "count", "avg_ns", "p50_ns", "p99_ns", "max_ns");
+    for (int hist = 0; hist < METRIC_HIST_COUNT; hist++) {
+        LatencyHistogram snapshot;
+        metrics_histogram_snapshot((MetricHistogram)hist, &snapshot);
+        proc_append(buffer, buffer_size, offset, "%-18s %8llu %10llu %10llu %10llu %10llu\n",
+                    histogram_names[hist],
+                    (unsigned long long)snapshot.count,
+                    (unsigned long long)(snapshot.count ? snapshot.sum / snapshot.count : 0),
+                    (unsigned long long)histogram_percentile(&snapshot, 50.0),
+                    (unsigned long long)histogram_percentile(&snapshot, 99.0),
+                    (unsigned long long)snapshot.max);
+    }
+}
+
+static void proc_diskstats(char* buffer, size_t buffer_size, size_t* offset) {
+    uint32_t queued = 0;
+    uint32_t in_flight = 0;
+
+    for (int i = 0; i < MAX_IO_REQUESTS; i++) {
+        queued += storage.requests[i].state == IO_QUEUED;
+        in_flight += storage.requests[i].state == IO_IN_FLIGHT;
+    }
+    proc_append(buffer, buffer_size, offset, "scheduler %s queued %u in_flight %u\n",
+                storage.policy == IO_SCHED_DEADLINE ? "deadline" : "fifo", queued, in_flight);
+    proc_append(buffer, buffer_size, offset, "requests %llu merges %llu commands %llu\n",
+                (unsigned long long)metrics_counter_total(COUNTER_IO_REQUESTS),
+                (unsigned long long)metrics_counter_total(COUNTER_IO_MERGES),
+                (unsigned long long)metrics_counter_total(COUNTER_IO_COMMANDS));
+}
+
+// Read a text snapshot of a kernel entry ("meminfo", "vmstat", "schedstat", "sensorstat", "cpufreq",
+// "diskstats", "latency")
+// Returns the number of bytes written, or 0 if the entry does not exist
+size_t kernel_proc_read(const char* entry, char* buffer, size_t buffer_size) {
+    size_t offset = 0;
+    if (buffer_size == 0) {
+        return 0;
+    }
+    buffer[0] = '\0';
+
+    if (strcmp(entry, "meminfo") == 0) {
+        proc_meminfo(buffer, buffer_size, &offset);
+    } else if (strcmp(entry, "vmstat") == 0) {
+        proc_vmstat(buffer, buffer_size, &offset);
+    } else if (strcmp(entry, "schedstat") == 0) {
+        proc_schedstat(buffer, buffer_size, &offset);
+    } else if (strcmp(entry, "sensorstat") == 0) {
+        proc_sensorstat(buffer, buffer_size, &offset);
+    } else if (strcmp(entry, "cpufreq") == 0) {
+        proc_cpufreq(buffer, buffer_size, &offset);
+    } else if (strcmp(entry, "diskstats") == 0) {
+        proc_diskstats(buffer, buffer_size, &offset);
+    } else if (strcmp(entry, "latency") == 0) {
+        proc_latency(buffer, buffer_size, &offset);
+    }
+    return offset;
+}
+
+// Kernel Event Stream --------------------------------------------------------------
+
+static KernelEvent* event_begin(KernelEventType type, uint32_t id, uint32_t value) {
+    KernelEvent* event = &kernel_events.events[kernel_events.write_sequence % EVENT_QUEUE_SIZE];
+    memset(event, 0, sizeof(KernelEvent));
+    event->type = type;
+    event->sequence = kernel_events.write_sequence;
+    event->id = id;
+    event->value = value;
+    return event;
+}
+
+static inline void event_commit() {
+    kernel_events.write_sequence++;
+}
+
+void publish_event(KernelEventType type, uint32_t id, uint32_t value) {
+    event_begin(type, id, value);
+    event_commit();
+}
+
+// Start receiving events published from now on
+void event_subscribe(EventSubscriber* subscriber) {
+    subscriber->read_sequence = kernel_events.write_sequence;
+}
+
+// Copy up to max_events pending events for a subscriber, returns how many were copied
+uint32_t event_poll(EventSubscriber* subscriber, KernelEvent* out, uint32_t max_events) {
+    uint32_t pending = kernel_events.write_sequence - subscriber->read_sequence;
+    uint32_t copied = 0;
+
+    if (max_events == 0) {
+        return 0;
+    }
+
+    // Missed events were overwritten, the subscriber has to rescan
+    if (pending > EVENT_QUEUE_SIZE) {
+        memset(&out[0], 0, sizeof(KernelEvent));
+        out[0].type = EVENT_RESYNC;
+        out[0].sequence = kernel_events.write_sequence;
+        subscriber->read_sequence = kernel_events.write_sequence;
+        return 1;
+    }
+
+    while (copied < pending && copied < max_events) {
+        out[copied] = kernel_events.events[subscriber->read_sequence % EVENT_QUEUE_SIZE];
+        subscriber->read_sequence++;
+        copied++;
+    }
+    return copied;
+}
+
+// Change a sensor's sampling rate and tell subscribers
+static void set_sensor_rate(int slot, uint16_t sampling_rate) {
+    if (mobile_kernel.sensors[slot].sampling_rate != sampling_rate) {
+        mobile_kernel.sensors[slot].sampling_rate = sampling_rate;
+        publish_event(EVENT_SENSOR_RATE_CHANGED, slot, sampling_rate);
+    }
+}
+
+// Sample the sensor once at the fastest rate anyone subscribed for, capped by the
+// hardware rate (halved when saving battery). Sensors nobody listens to power down
+static void recompute_sensor_rate(int slot) {
+    SensorConfig* sensor = &mobile_kernel.sensors[slot];
+    uint16_t wanted = 0;
+    uint16_t cap = sensor->base_sampling_rate;
+
+    for (int i = 0; i < MAX_SENSOR_SUBSCRIPTIONS; i++) {
+        const SensorSubscription* sub = &sensor_subscriptions[i];
+        if (sub->is_active && sub->sensor_slot == slot && sub->requested_rate > wanted) {
+            wanted = sub->requested_rate;
+        }
+    }
+    if (mobile_kernel.current_power_mode == POWER_BATTERY_SAVE ||
+        mobile_kernel.current_power_mode == POWER_ULTRA_BATTERY_SAVE) {
+        cap = cap > 1 ? cap / 2 : cap;
+    }
+    set_sensor_rate(slot, wanted < cap ? wanted : cap);
+
+    for (int i = 0; i < MAX_SENSOR_SUBSCRIPTIONS; i++) {
+        SensorSubscription* sub = &sensor_subscriptions[i];
+        if (sub->is_active && sub->sensor_slot == slot) {
+            sub->decimation = sub->requested_rate < sensor->sampling_rate ? sensor->sampling_rate / sub->requested_rate : 1;
+        }
+    }
+}
+
+// Counted in GAUGE_RUNNABLE_TASKS: not suspended, and not a zygote template
+static bool counts_as_runnable(const EnhancedProcessControlBlock* process) {
+    return process->power_state != POWER_SUSPEND && !process->is_zygote;
+}
+
+// Suspend one process, keeping the runnable gauge and event subscribers in step
+bool suspend_process(uint32_t pid) {
+    if (pid == 0 || pid > MAX_PROCESSES || mobile_kernel.processes[pid - 1].pid != pid) {
+        return false;
+    }
+
+    if (mobile_kernel.processes[pid - 1].power_state != POWER_SUSPEND) {
+        if (counts_as_runnable(&mobile_kernel.processes[pid - 1])) {
+            metrics_gauge_add(GAUGE_RUNNABLE_TASKS, -1);
+        }
+        mobile_kernel.processes[pid - 1].power_state = POWER_SUSPEND;
+        publish_event(EVENT_POWER_STATE_CHANGED, pid, POWER_SUSPEND);
+    }
+    return true;
+}
+
 // Power Management
 void power_management(PowerManagementState new_state) {
+    uint64_t start = monotonic_ns();
     mobile_kernel.current_power_mode = new_state;
+    metrics_count(COUNTER_POWER_TRANSITIONS, 1);
+    publish_event(EVENT_POWER_MODE_CHANGED, 0, new_state);
     
     switch (new_state) {
         case POWER_FULL:
-            // Maximum performance, all resources active
+        case POWER_INTERACTIVE:
+            // Maximum performance, all resources active & sensors back at their subscribed rates
+            for (int i = 0; i < MAX_SENSORS; i++) {
+                if (mobile_kernel.sensors[i].is_active) {
+                    recompute_sensor_rate(i);
+                }
+            }
             break;
         
         case POWER_BATTERY_SAVE:
             // Reduce background processes & lower sensor sampling rates
             for (int i = 0; i < MAX_SENSORS; i++) {
                 if (mobile_kernel.sensors[i].is_active) {
-                    mobile_kernel.sensors[i].sampling_rate /= 2;
+                    recompute_sensor_rate(i);
                 }
             }
             break;
         
         case POWER_ULTRA_BATTERY_SAVE:
             // Suspend non-critical processes & disable most sensors
+            for (int i = 0; i < MAX_SENSORS; i++) {
+                if (mobile_kernel.sensors[i].is_active) {
+                    recompute_sensor_rate(i);
+                }
+            }
             for (int i = 0; i < MAX_PROCESSES; i++) {
                 if (mobile_kernel.processes[i].priority < 2) {
-                    mobile_kernel.processes[i].power_state = POWER_SUSPEND;
+                    suspend_process(mobile_kernel.processes[i].pid);
                 }
             }
             break;
@@ -116,100 +959,1763 @@ void power_management(PowerManagementState new_state) {
         default:
             break;
     }
+
+    metrics_record_latency(HIST_POWER_MANAGEMENT, monotonic_ns() - start);
 }
 
-// Sensor Management
-bool register_sensor(SensorType type, uint16_t sampling_rate) {
-    for (int i = 0; i < MAX_SENSORS; i++) {
-        if (!mobile_kernel.sensors[i].is_active) {
-            mobile_kernel.sensors[i].type = type;
-            mobile_kernel.sensors[i].is_active = true;
-            mobile_kernel.sensors[i].sampling_rate = sampling_rate;
-            
-            // Allocate sensor data buffer
-            mobile_kernel.sensors[i].data_buffer = malloc(1024);
-            
-            return true;
-        }
+// CPU Frequency Governor -------------------------------------------------------------
+
+void governor_init(GovernorPolicy policy) {
+    memset(&cpu_governor, 0, sizeof(CpuGovernor));
+    cpu_governor.policy = policy;
+    cpu_governor.thermal_cap = CPU_OPP_COUNT - 1;
+    cpu_governor.temperature = THERMAL_AMBIENT;
+    cpu_governor.pending_mode = mobile_kernel.current_power_mode;
+}
+
+// Highest operating point each power mode allows
+static uint8_t power_mode_opp_cap(PowerManagementState mode) {
+    switch (mode) {
+        case POWER_FULL:
+            return CPU_OPP_COUNT - 1;
+        case POWER_INTERACTIVE:
+            return CPU_OPP_COUNT - 2;
+        case POWER_BATTERY_SAVE:
+            return 1;
+        default:
+            return 0;
     }
-    return false;
 }
 
-// Process Creation with Permissions
-uint32_t create_process(
-    const char* process_name, 
-    uint8_t priority, 
-    AppPermission* required_permissions,
-    uint8_t permission_count
-) {
-    for (int i = 0; i < MAX_PROCESSES; i++) {
-        if (mobile_kernel.processes[i].pid == 0) {
-            // Initialize process
-            mobile_kernel.processes[i].pid = i + 1;
-            strncpy(mobile_kernel.processes[i].process_name, process_name, 31);
-            mobile_kernel.processes[i].priority = priority;
-            mobile_kernel.processes[i].last_active_timestamp = system_time();
-            
-            // Set process permissions
+// PELT-style decay: util = util * y + running contribution, with y^32 = 0.5
+static void governor_update_util(int cpu, bool running) {
+    uint32_t contribution = 0;
+    if (running) {
+        // Scale by the current frequency so the load is frequency invariant
+        contribution = 1024 * cpu_opps[cpu_governor.cpu_opp[cpu]].freq_mhz / cpu_opps[CPU_OPP_COUNT - 1].freq_mhz;
+    }
+    cpu_governor.cpu_util[cpu] = (cpu_governor.cpu_util[cpu] * PELT_DECAY + contribution * (1024 - PELT_DECAY)) >> 10;
+}
+
+// Step power modes on average utilization, a mode must be wanted for a while before switching
+static void governor_update_power_mode() {
+    uint32_t total = 0;
+    for (int cpu = 0; cpu < MAX_CPUS; cpu++) {
+        total += cpu_governor.cpu_util[cpu];
+    }
+    uint32_t average = total / MAX_CPUS;
+
+    PowerManagementState current = mobile_kernel.current_power_mode;
+    PowerManagementState wanted = current;
+    switch (current) {
+        case POWER_FULL:
+            if (average < GOVERNOR_FULL_EXIT_UTIL) wanted = POWER_INTERACTIVE;
+            break;
+        case POWER_INTERACTIVE:
+            if (average > GOVERNOR_FULL_ENTER_UTIL) wanted = POWER_FULL;
+            else if (average < GOVERNOR_SAVE_ENTER_UTIL) wanted = POWER_BATTERY_SAVE;
+            break;
+        case POWER_BATTERY_SAVE:
+            if (average > GOVERNOR_SAVE_EXIT_UTIL) wanted = POWER_INTERACTIVE;
+            break;
+        default:
+            // Ultra battery save and suspend are only entered and left explicitly
+            return;
+    }
+
+    if (wanted == current || wanted != cpu_governor.pending_mode) {
+        cpu_governor.pending_mode = wanted;
+        cpu_governor.mode_hold_ticks = 0;
+        return;
+    }
+    if (++cpu_governor.mode_hold_ticks >= GOVERNOR_HYSTERESIS_TICKS) {
+        power_management(wanted);
+        cpu_governor.mode_switches++;
+        cpu_governor.mode_hold_ticks = 0;
+    }
+}
+
+// First order thermal model, throttles one operating point at a time
+static void governor_update_thermal(uint32_t power_mw) {
+    double target = THERMAL_AMBIENT + THERMAL_RESISTANCE * power_mw / 1000.0;
+    cpu_governor.temperature += (target - cpu_governor.temperature) / THERMAL_TIME_CONSTANT_TICKS;
+
+    if (cpu_governor.thermal_hold_ticks > 0) {
+        cpu_governor.thermal_hold_ticks--;
+    } else if (cpu_governor.temperature > THERMAL_TRIP && cpu_governor.thermal_cap > 0) {
+        cpu_governor.thermal_cap--;
+        cpu_governor.thermal_hold_ticks = THERMAL_STEP_TICKS;
+    } else if (cpu_governor.temperature < THERMAL_RELEASE && cpu_governor.thermal_cap < CPU_OPP_COUNT - 1) {
+        cpu_governor.thermal_cap++;
+        cpu_governor.thermal_hold_ticks = THERMAL_STEP_TICKS;
+    }
+
+    if (cpu_governor.thermal_cap < CPU_OPP_COUNT - 1) {
+        cpu_governor.throttled_ticks++;
+    }
+}
+
+static uint8_t governor_select_opp(int cpu) {
+    uint8_t cap = power_mode_opp_cap(mobile_kernel.current_power_mode);
+    uint8_t opp = 0;
+
+    switch (cpu_governor.policy) {
+        case GOVERNOR_PERFORMANCE:
+            opp = CPU_OPP_COUNT - 1;
+            break;
+        case GOVERNOR_POWERSAVE:
+            opp = 0;
+            break;
+        default: {
+            // Lowest frequency that covers the load with 25% headroom
+            uint32_t target = cpu_opps[CPU_OPP_COUNT - 1].freq_mhz * cpu_governor.cpu_util[cpu] * 5 / 4 / 1024;
+            while (opp < CPU_OPP_COUNT - 1 && cpu_opps[opp].freq_mhz < target) {
+                opp++;
+            }
+            break;
+        }
+    }
+
+    if (opp > cap) opp = cap;
+    if (opp > cpu_governor.thermal_cap) opp = cpu_governor.thermal_cap;
+    return opp;
+}
+
+// One governor tick, cpu_busy says which CPUs ran a task during it
+// Returns the power drawn by the CPUs in mW
+uint32_t governor_tick(const bool cpu_busy[MAX_CPUS]) {
+    uint32_t power_mw = 0;
+
+    for (int cpu = 0; cpu < MAX_CPUS; cpu++) {
+        const OperatingPoint* opp = &cpu_opps[cpu_governor.cpu_opp[cpu]];
+        power_mw += cpu_busy[cpu] ? opp->active_mw : opp->idle_mw;
+        governor_update_util(cpu, cpu_busy[cpu]);
+    }
+
+    if (cpu_governor.policy == GOVERNOR_SCHEDUTIL) {
+        governor_update_power_mode();
+    }
+    governor_update_thermal(power_mw);
+
+    for (int cpu = 0; cpu < MAX_CPUS; cpu++) {
+        cpu_governor.cpu_opp[cpu] = governor_select_opp(cpu);
+    }
+    return power_mw;
+}
+
+uint32_t governor_cpu_freq(int cpu) {
+    return cpu_opps[cpu_governor.cpu_opp[cpu]].freq_mhz;
+}
+
+// Sensor Management
+bool register_sensor(SensorType type, uint16_t sampling_rate) {
+    for (int i = 0; i < MAX_SENSORS; i++) {
+        if (!mobile_kernel.sensors[i].is_active) {
+            mobile_kernel.sensors[i].type = type;
+            mobile_kernel.sensors[i].is_active = true;
+            mobile_kernel.sensors[i].sampling_rate = 0; // Powered down until someone subscribes
+            mobile_kernel.sensors[i].base_sampling_rate = sampling_rate;
+            mobile_kernel.sensors[i].samples_written = 0;
+            mobile_kernel.sensors[i].subscriber_count = 0;
+            
+            // Allocate sensor data buffer
+            mobile_kernel.sensors[i].data_buffer = malloc(1024);
+            metrics_gauge_add(GAUGE_ACTIVE_SENSORS, 1);
+
+            KernelEvent* event = event_begin(EVENT_SENSOR_ADDED, i, 0);
+            event->sensor_type = type;
+            event_commit();
+            
+            return true;
+        }
+    }
+    return false;
+}
+
+// Sensor Subscriptions ---------------------------------------------------------------
+
+// Permission a process needs to read a sensor type
+static AppPermission sensor_permission(SensorType type) {
+    return type == SENSOR_GPS ? PERM_LOCATION : PERM_SENSORS;
+}
+
+// Subscribe a process to a sensor type at a desired rate, subscribing again changes the rate
+// Returns the subscription id, or 0 if the sensor is missing or the permission is not held
+uint32_t sensor_subscribe(uint32_t pid, SensorType type, uint16_t rate) {
+    if (pid == 0 || pid > MAX_PROCESSES || mobile_kernel.processes[pid - 1].pid != pid || rate == 0) {
+        return 0;
+    }
+    if (!mobile_kernel.processes[pid - 1].permissions[sensor_permission(type)]) {
+        return 0;
+    }
+
+    int slot = -1;
+    for (int i = 0; i < MAX_SENSORS && slot < 0; i++) {
+        if (mobile_kernel.sensors[i].is_active && mobile_kernel.sensors[i].type == type) {
+            slot = i;
+        }
+    }
+    if (slot < 0) {
+        return 0;
+    }
+
+    for (int i = 0; i < MAX_SENSOR_SUBSCRIPTIONS; i++) {
+        SensorSubscription* sub = &sensor_subscriptions[i];
+        if (sub->is_active && sub->pid == pid && sub->sensor_slot == slot) {
+            sub->requested_rate = rate; // Unread samples stay queued
+            recompute_sensor_rate(slot);
+            return (uint32_t)i + 1;
+        }
+    }
+
+    for (int i = 0; i < MAX_SENSOR_SUBSCRIPTIONS; i++) {
+        SensorSubscription* sub = &sensor_subscriptions[i];
+        if (!sub->is_active) {
+            sub->is_active = true;
+            sub->pid = pid;
+            sub->sensor_slot = (uint8_t)slot;
+            sub->requested_rate = rate;
+            sub->decimation = 1;
+            sub->next_sample = mobile_kernel.sensors[slot].samples_written;
+            mobile_kernel.sensors[slot].subscriber_count++;
+            recompute_sensor_rate(slot);
+            return (uint32_t)i + 1;
+        }
+    }
+    return 0;
+}
+
+bool sensor_unsubscribe(uint32_t subscription_id) {
+    if (subscription_id == 0 || subscription_id > MAX_SENSOR_SUBSCRIPTIONS ||
+        !sensor_subscriptions[subscription_id - 1].is_active) {
+        return false;
+    }
+
+    SensorSubscription* sub = &sensor_subscriptions[subscription_id - 1];
+    sub->is_active = false;
+    mobile_kernel.sensors[sub->sensor_slot].subscriber_count--;
+    recompute_sensor_rate(sub->sensor_slot);
+    return true;
+}
+
+// Drop every subscription a process holds
+static void sensor_unsubscribe_all(uint32_t pid) {
+    for (int i = 0; i < MAX_SENSOR_SUBSCRIPTIONS; i++) {
+        if (sensor_subscriptions[i].is_active && sensor_subscriptions[i].pid == pid) {
+            sensor_unsubscribe((uint32_t)i + 1);
+        }
+    }
+}
+
+// Store one reading in the sensor's shared ring
+void sensor_push_sample(int slot, int32_t value) {
+    SensorConfig* sensor = &mobile_kernel.sensors[slot];
+    ((int32_t*)sensor->data_buffer)[sensor->samples_written % SENSOR_RING_SAMPLES] = value;
+    sensor->samples_written++;
+    metrics_count(COUNTER_SENSOR_SAMPLES, 1);
+}
+
+// Hand a subscriber the decimated samples produced since its last poll, without copying
+// A sample is delivered once its whole decimation group has been written, samples that
+// were overwritten before the poll are skipped. Returns the batch size
+uint32_t sensor_poll(uint32_t subscription_id, SensorBatch* batch) {
+    memset(batch, 0, sizeof(SensorBatch));
+    if (subscription_id == 0 || subscription_id > MAX_SENSOR_SUBSCRIPTIONS ||
+        !sensor_subscriptions[subscription_id - 1].is_active) {
+        return 0;
+    }
+
+    SensorSubscription* sub = &sensor_subscriptions[subscription_id - 1];
+    const SensorConfig* sensor = &mobile_kernel.sensors[sub->sensor_slot];
+    uint32_t written = sensor->samples_written;
+    int32_t pending = (int32_t)(written - sub->next_sample); // Signed, the counters may wrap
+
+    if (pending > (int32_t)SENSOR_RING_SAMPLES) {
+        sub->next_sample = written - SENSOR_RING_SAMPLES;
+        pending = SENSOR_RING_SAMPLES;
+    }
+    if (pending < (int32_t)sub->decimation) {
+        return 0;
+    }
+
+    batch->ring = (const int32_t*)sensor->data_buffer;
+    batch->start = sub->next_sample % SENSOR_RING_SAMPLES;
+    batch->stride = sub->decimation;
+    batch->count = (uint32_t)pending / sub->decimation;
+    sub->next_sample += batch->count * sub->decimation; // Never past written
+    return batch->count;
+}
+
+static inline int32_t sensor_batch_sample(const SensorBatch* batch, uint32_t index) {
+    return batch->ring[(batch->start + index * batch->stride) % SENSOR_RING_SAMPLES];
+}
+
+// Storage I/O Scheduler --------------------------------------------------------------
+
+// Open (or create) the backing file and reset the queues
+bool storage_init(const char* path, IoSchedulerPolicy policy) {
+    if (storage.backing != NULL) {
+        fclose(storage.backing);
+    }
+    memset(&storage, 0, sizeof(StorageDevice));
+    storage.policy = policy;
+    for (int c = 0; c < IO_QUEUE_DEPTH; c++) {
+        storage.channel[c] = -1;
+    }
+
+    storage.backing = fopen(path, "r+b");
+    if (storage.backing == NULL) {
+        storage.backing = fopen(path, "w+b");
+    }
+    return storage.backing != NULL;
+}
+
+// Queue a read or write of whole blocks for a process holding PERM_STORAGE
+// Returns the request id, or 0 if the request was refused
+uint32_t io_submit(uint32_t pid, IoDirection direction, uint32_t block, uint32_t block_count, void* buffer) {
+    if (pid == 0 || pid > MAX_PROCESSES || mobile_kernel.processes[pid - 1].pid != pid ||
+        !mobile_kernel.processes[pid - 1].permissions[PERM_STORAGE]) {
+        return 0;
+    }
+    if (storage.backing == NULL || buffer == NULL || block_count == 0 || block_count > IO_MAX_MERGE_BLOCKS ||
+        block >= IO_DEVICE_BLOCKS || block_count > IO_DEVICE_BLOCKS - block) {
+        return 0;
+    }
+
+    for (int i = 0; i < MAX_IO_REQUESTS; i++) {
+        IoRequest* request = &storage.requests[i];
+        if (request->state == IO_FREE) {
+            memset(request, 0, sizeof(IoRequest));
+            request->state = IO_QUEUED;
+            request->id = ++storage.next_id;
+            request->pid = pid;
+            request->direction = direction;
+            request->io_class = mobile_kernel.processes[pid - 1].permissions[PERM_BACKGROUND_PROCESS] ?
+                                IO_CLASS_BACKGROUND : IO_CLASS_FOREGROUND;
+            request->block = block;
+            request->block_count = block_count;
+            request->buffer = buffer;
+            request->submit_us = storage.now_us;
+            request->expire_us = storage.now_us + (direction == IO_READ ? IO_READ_EXPIRE_US : IO_WRITE_EXPIRE_US);
+            request->next_merged = -1;
+            metrics_count(COUNTER_IO_REQUESTS, 1);
+            return request->id;
+        }
+    }
+    return 0;
+}
+
+// Drop the queued requests of an exiting process, commands already in service still finish
+static void io_cancel_all(uint32_t pid) {
+    for (int i = 0; i < MAX_IO_REQUESTS; i++) {
+        if (storage.requests[i].state == IO_QUEUED && storage.requests[i].pid == pid) {
+            storage.requests[i].state = IO_FREE;
+        }
+    }
+}
+
+// Pick the next request of one class: an expired one first, otherwise the
+// next block at or after the head position, wrapping to the lowest block
+static int io_pick_in_class(IoClass io_class) {
+    int oldest = -1;
+    int ahead = -1;
+    int lowest = -1;
+
+    for (int i = 0; i < MAX_IO_REQUESTS; i++) {
+        const IoRequest* request = &storage.requests[i];
+        if (request->state != IO_QUEUED || request->io_class != io_class) {
+            continue;
+        }
+        if (oldest < 0 || request->id < storage.requests[oldest].id) {
+            oldest = i;
+        }
+        if (request->block >= storage.head_block &&
+            (ahead < 0 || request->block < storage.requests[ahead].block)) {
+            ahead = i;
+        }
+        if (lowest < 0 || request->block < storage.requests[lowest].block) {
+            lowest = i;
+        }
+    }
+
+    if (oldest >= 0 && storage.requests[oldest].expire_us <= storage.now_us) {
+        return oldest;
+    }
+    return ahead >= 0 ? ahead : lowest;
+}
+
+static int io_pick_next() {
+    if (storage.policy == IO_SCHED_FIFO) {
+        int oldest = -1;
+        for (int i = 0; i < MAX_IO_REQUESTS; i++) {
+            if (storage.requests[i].state == IO_QUEUED &&
+                (oldest < 0 || storage.requests[i].id < storage.requests[oldest].id)) {
+                oldest = i;
+            }
+        }
+        return oldest;
+    }
+
+    int foreground = io_pick_in_class(IO_CLASS_FOREGROUND);
+    int background = io_pick_in_class(IO_CLASS_BACKGROUND);
+    if (foreground < 0 || background < 0) {
+        storage.foreground_streak = 0;
+        return foreground >= 0 ? foreground : background;
+    }
+
+    // Background only goes first once it has expired or waited out a foreground streak
+    if (storage.requests[background].expire_us <= storage.now_us ||
+        storage.foreground_streak >= IO_FOREGROUND_STREAK) {
+        storage.foreground_streak = 0;
+        return background;
+    }
+    storage.foreground_streak++;
+    return foreground;
+}
+
+// Grow the command around the first request with queued requests for the blocks
+// directly before or after it. Returns the request the command starts at
+static int io_merge(int first) {
+    int last = first;
+    uint32_t start = storage.requests[first].block;
+    uint32_t end = start + storage.requests[first].block_count;
+    bool merged = true;
+
+    while (merged) {
+        merged = false;
+        for (int i = 0; i < MAX_IO_REQUESTS; i++) {
+            IoRequest* request = &storage.requests[i];
+            if (request->state != IO_QUEUED || request->direction != storage.requests[first].direction ||
+                end - start + request->block_count > IO_MAX_MERGE_BLOCKS) {
+                continue;
+            }
+            if (request->block == end) {
+                storage.requests[last].next_merged = (int16_t)i;
+                last = i;
+                end += request->block_count;
+            } else if (request->block + request->block_count == start) {
+                request->next_merged = (int16_t)first;
+                first = i;
+                start = request->block;
+            } else {
+                continue;
+            }
+            request->state = IO_IN_FLIGHT;
+            metrics_count(COUNTER_IO_MERGES, 1);
+            merged = true;
+        }
+    }
+    return first;
+}
+
+// Start one device command on a channel. The data moves through the backing file now,
+// its completion is posted when the modelled device would have finished it
+static void io_dispatch(int channel, int first) {
+    storage.requests[first].state = IO_IN_FLIGHT;
+    if (storage.policy == IO_SCHED_DEADLINE) {
+        first = io_merge(first);
+    }
+
+    uint32_t start = storage.requests[first].block;
+    uint32_t blocks = 0;
+    bool ok = fseek(storage.backing, (long)start * IO_BLOCK_SIZE, SEEK_SET) == 0;
+
+    for (int i = first; i >= 0; i = storage.requests[i].next_merged) {
+        IoRequest* request = &storage.requests[i];
+        size_t bytes = (size_t)request->block_count * IO_BLOCK_SIZE;
+        size_t done = 0;
+
+        if (ok && request->direction == IO_WRITE) {
+            done = fwrite(request->buffer, 1, bytes, storage.backing);
+            ok = done == bytes;
+        } else if (ok) {
+            // Blocks never written read back as zeroes
+            done = fread(request->buffer, 1, bytes, storage.backing);
+            memset(request->buffer + done, 0, bytes - done);
+            done = bytes;
+        }
+        request->result = ok ? (int32_t)done : -1;
+        blocks += request->block_count;
+    }
+    if (storage.requests[first].direction == IO_WRITE) {
+        fflush(storage.backing);
+    }
+
+    uint64_t service_us = IO_COMMAND_US + (uint64_t)blocks * IO_BLOCK_US;
+    if (start != storage.head_block) {
+        service_us += IO_SEEK_US;
+    }
+    storage.head_block = start + blocks;
+    storage.channel[channel] = (int16_t)first;
+    storage.channel_busy_until[channel] = storage.now_us + service_us;
+    metrics_count(COUNTER_IO_COMMANDS, 1);
+}
+
+static void io_complete(int channel) {
+    for (int i = storage.channel[channel]; i >= 0; i = storage.requests[i].next_merged) {
+        IoRequest* request = &storage.requests[i];
+        request->state = IO_COMPLETE;
+        request->complete_us = storage.now_us;
+        storage.completions[storage.completion_tail++ % MAX_IO_REQUESTS] = (uint16_t)i;
+        metrics_record_latency(HIST_STORAGE_IO, (request->complete_us - request->submit_us) * 1000);
+    }
+    storage.channel[channel] = -1;
+}
+
+// Run the device until the given time, dispatching whenever a channel is idle
+void io_advance(uint64_t until_us) {
+    while (true) {
+        for (int c = 0; c < IO_QUEUE_DEPTH; c++) {
+            if (storage.channel[c] < 0) {
+                int next = io_pick_next();
+                if (next < 0) {
+                    break;
+                }
+                io_dispatch(c, next);
+            }
+        }
+
+        int finishing = -1;
+        for (int c = 0; c < IO_QUEUE_DEPTH; c++) {
+            if (storage.channel[c] >= 0 &&
+                (finishing < 0 || storage.channel_busy_until[c] < storage.channel_busy_until[finishing])) {
+                finishing = c;
+            }
+        }
+        if (finishing < 0 || storage.channel_busy_until[finishing] > until_us) {
+            break;
+        }
+        if (storage.channel_busy_until[finishing] > storage.now_us) {
+            storage.now_us = storage.channel_busy_until[finishing];
+        }
+        io_complete(finishing);
+    }
+
+    if (until_us > storage.now_us) {
+        storage.now_us = until_us;
+    }
+}
+
+// Take the next completion off the queue and free its request slot
+bool io_reap(IoCompletion* completion) {
+    if (storage.completion_head == storage.completion_tail) {
+        return false;
+    }
+
+    IoRequest* request = &storage.requests[storage.completions[storage.completion_head++ % MAX_IO_REQUESTS]];
+    completion->id = request->id;
+    completion->pid = request->pid;
+    completion->result = request->result;
+    completion->latency_us = request->complete_us - request->submit_us;
+    request->state = IO_FREE;
+    return true;
+}
+
+// Virtual Memory ---------------------------------------------------------------------
+
+void vm_init() {
+    free(virtual_memory.frames);
+    free(virtual_memory.free_frames);
+    for (int i = 0; i < MAX_PROCESSES; i++) {
+        for (int t = 0; t < PTES_PER_TABLE; t++) {
+            free(virtual_memory.spaces[i].tables[t]);
+        }
+    }
+    memset(&virtual_memory, 0, sizeof(VirtualMemory));
+
+    virtual_memory.frame_count = mobile_kernel.total_memory / PAGE_SIZE;
+    virtual_memory.frames = calloc(virtual_memory.frame_count, sizeof(PhysicalFrame));
+    virtual_memory.free_frames = malloc(virtual_memory.frame_count * sizeof(uint32_t));
+
+    // Hand out low frame numbers first
+    for (uint32_t i = 0; i < virtual_memory.frame_count; i++) {
+        virtual_memory.free_frames[i] = virtual_memory.frame_count - 1 - i;
+    }
+    virtual_memory.free_count = virtual_memory.frame_count;
+}
+
+static uint32_t* pte_lookup(uint32_t pid, uint32_t vpn, bool create) {
+    AddressSpace* space = &virtual_memory.spaces[pid - 1];
+    uint32_t dir_index = vpn / PTES_PER_TABLE;
+
+    if (space->tables[dir_index] == NULL) {
+        if (!create) {
+            return NULL;
+        }
+        space->tables[dir_index] = calloc(1, sizeof(PageTable));
+        if (space->tables[dir_index] == NULL) {
+            return NULL;
+        }
+    }
+    return &space->tables[dir_index]->entries[vpn % PTES_PER_TABLE];
+}
+
+static void tlb_invalidate(uint32_t pid, uint32_t vpn) {
+    TlbEntry* set = virtual_memory.tlb[vpn % TLB_SETS];
+    for (int way = 0; way < TLB_WAYS; way++) {
+        if (set[way].valid && set[way].pid == pid && set[way].vpn == vpn) {
+            set[way].valid = false;
+        }
+    }
+}
+
+static void tlb_flush_pid(uint32_t pid) {
+    for (int s = 0; s < TLB_SETS; s++) {
+        for (int way = 0; way < TLB_WAYS; way++) {
+            if (virtual_memory.tlb[s][way].pid == pid) {
+                virtual_memory.tlb[s][way].valid = false;
+            }
+        }
+    }
+}
+
+static TlbEntry* tlb_lookup(uint32_t pid, uint32_t vpn) {
+    TlbEntry* set = virtual_memory.tlb[vpn % TLB_SETS];
+    for (int way = 0; way < TLB_WAYS; way++) {
+        if (set[way].valid && set[way].pid == pid && set[way].vpn == vpn) {
+            set[way].last_used = ++virtual_memory.tlb_clock;
+            return &set[way];
+        }
+    }
+    return NULL;
+}
+
+// Insert a translation, replacing the least recently used way of its set
+static void tlb_fill(uint32_t pid, uint32_t vpn, uint32_t pte) {
+    TlbEntry* set = virtual_memory.tlb[vpn % TLB_SETS];
+    TlbEntry* victim = &set[0];
+    for (int way = 0; way < TLB_WAYS; way++) {
+        if (!set[way].valid) {
+            victim = &set[way];
+            break;
+        }
+        if (set[way].last_used < victim->last_used) {
+            victim = &set[way];
+        }
+    }
+
+    victim->valid = true;
+    victim->pid = pid;
+    victim->vpn = vpn;
+    victim->pfn = pte >> PAGE_SHIFT;
+    victim->writable = (pte & PTE_WRITABLE) != 0;
+    victim->last_used = ++virtual_memory.tlb_clock;
+}
+
+static void frame_release(uint32_t pfn) {
+    memset(&virtual_memory.frames[pfn], 0, sizeof(PhysicalFrame));
+    virtual_memory.free_frames[virtual_memory.free_count++] = pfn;
+    mobile_kernel.available_memory += PAGE_SIZE;
+    metrics_gauge_add(GAUGE_AVAILABLE_MEMORY, PAGE_SIZE);
+}
+
+// Unmap one private page and put it in (simulated) swap
+static void evict_frame(uint32_t pfn) {
+    PhysicalFrame* frame = &virtual_memory.frames[pfn];
+    uint32_t* pte = pte_lookup(frame->owner_pid, frame->vpn, false);
+
+    if (pte != NULL) {
+        *pte = (*pte & PTE_WRITABLE) | PTE_SWAPPED;
+    }
+    tlb_invalidate(frame->owner_pid, frame->vpn);
+    virtual_memory.spaces[frame->owner_pid - 1].resident_pages--;
+    mobile_kernel.processes[frame->owner_pid - 1].memory_usage -= PAGE_SIZE;
+    frame_release(pfn);
+}
+
+// Zygote pages stay resident: swap holds no contents in this model, so a child forked
+// after eviction would fault in a zeroed page instead of the preloaded one
+static bool frame_pinned(const PhysicalFrame* frame) {
+    return mobile_kernel.processes[frame->owner_pid - 1].is_zygote;
+}
+
+// Free up to target pages: suspended processes first, then a second chance clock
+// Returns the number of pages reclaimed
+uint32_t reclaim_pages(uint32_t target) {
+    uint32_t reclaimed = 0;
+
+    for (uint32_t pfn = 0; pfn < virtual_memory.frame_count && reclaimed < target; pfn++) {
+        PhysicalFrame* frame = &virtual_memory.frames[pfn];
+        if (frame->map_count == 1 && !frame->shared && !frame_pinned(frame) &&
+            mobile_kernel.processes[frame->owner_pid - 1].power_state == POWER_SUSPEND) {
+            evict_frame(pfn);
+            reclaimed++;
+        }
+    }
+
+    for (uint32_t step = 0; step < 2 * virtual_memory.frame_count && reclaimed < target; step++) {
+        uint32_t pfn = virtual_memory.clock_hand;
+        PhysicalFrame* frame = &virtual_memory.frames[pfn];
+        virtual_memory.clock_hand = (pfn + 1) % virtual_memory.frame_count;
+
+        if (frame->map_count != 1 || frame->shared || frame_pinned(frame)) {
+            continue; // Free, shared and not worth unmapping everywhere, or pinned
+        }
+        if (frame->referenced) {
+            frame->referenced = false;
+            continue;
+        }
+        evict_frame(pfn);
+        reclaimed++;
+    }
+
+    metrics_count(COUNTER_PAGES_RECLAIMED, reclaimed);
+    return reclaimed;
+}
+
+static bool frame_alloc(uint32_t* pfn) {
+    if ((virtual_memory.free_count == 0 || mobile_kernel.available_memory < PAGE_SIZE) && reclaim_pages(1) == 0) {
+        return false;
+    }
+    if (virtual_memory.free_count == 0 || mobile_kernel.available_memory < PAGE_SIZE) {
+        return false;
+    }
+
+    *pfn = virtual_memory.free_frames[--virtual_memory.free_count];
+    mobile_kernel.available_memory -= PAGE_SIZE;
+    metrics_gauge_add(GAUGE_AVAILABLE_MEMORY, -PAGE_SIZE);
+    return true;
+}
+
+// Back a non-present page with a zeroed (or swapped back in) frame
+static bool handle_page_fault(uint32_t pid, uint32_t vpn, uint32_t* pte) {
+    uint64_t start = monotonic_ns();
+    uint32_t pfn;
+
+    if (!frame_alloc(&pfn)) {
+        return false;
+    }
+
+    metrics_count((*pte & PTE_SWAPPED) ? COUNTER_MAJOR_FAULTS : COUNTER_PAGE_FAULTS, 1);
+    virtual_memory.frames[pfn].owner_pid = pid;
+    virtual_memory.frames[pfn].vpn = vpn;
+    virtual_memory.frames[pfn].map_count = 1;
+    virtual_memory.frames[pfn].referenced = true;
+    *pte = (pfn << PAGE_SHIFT) | PTE_PRESENT | PTE_WRITABLE;
+
+    virtual_memory.spaces[pid - 1].resident_pages++;
+    mobile_kernel.processes[pid - 1].memory_usage += PAGE_SIZE;
+    metrics_record_latency(HIST_PAGE_FAULT, monotonic_ns() - start);
+    return true;
+}
+
+// First write to a copy-on-write page
+static bool handle_cow_fault(uint32_t pid, uint32_t vpn, uint32_t* pte) {
+    uint64_t start = monotonic_ns();
+    PhysicalFrame* shared = &virtual_memory.frames[*pte >> PAGE_SHIFT];
+
+    if (shared->map_count == 1) {
+        // Everyone else has copied or exited, take the page over
+        shared->owner_pid = pid;
+        shared->vpn = vpn;
+        shared->shared = false;
+        *pte = (*pte & ~PTE_COW) | PTE_WRITABLE;
+    } else {
+        uint32_t pfn;
+        if (!frame_alloc(&pfn)) {
+            return false;
+        }
+        shared->map_count--;
+        virtual_memory.frames[pfn].owner_pid = pid;
+        virtual_memory.frames[pfn].vpn = vpn;
+        virtual_memory.frames[pfn].map_count = 1;
+        virtual_memory.frames[pfn].referenced = true;
+        *pte = (pfn << PAGE_SHIFT) | PTE_PRESENT | PTE_WRITABLE;
+    }
+
+    tlb_invalidate(pid, vpn);
+    metrics_count(COUNTER_COW_FAULTS, 1);
+    metrics_record_latency(HIST_PAGE_FAULT, monotonic_ns() - start);
+    return true;
+}
+
+// Touch one byte of a process's address space, every address is anonymous demand-zero memory
+// Returns false if the page could not be backed
+bool vm_access(uint32_t pid, uint32_t vaddr, bool write) {
+    uint32_t vpn = vaddr >> PAGE_SHIFT;
+    TlbEntry* entry = tlb_lookup(pid, vpn);
+
+    if (entry != NULL && (!write || entry->writable)) {
+        // Hits skip the page table walk but still count as a use for the reclaim clock
+        virtual_memory.frames[entry->pfn].referenced = true;
+        metrics_count(COUNTER_TLB_HITS, 1);
+        return true;
+    }
+    metrics_count(COUNTER_TLB_MISSES, 1);
+
+    // Page table walk
+    uint32_t* pte = pte_lookup(pid, vpn, true);
+    if (pte == NULL) {
+        return false;
+    }
+    if (!(*pte & PTE_PRESENT) && !handle_page_fault(pid, vpn, pte)) {
+        return false;
+    }
+    if (write && (*pte & PTE_COW) && !handle_cow_fault(pid, vpn, pte)) {
+        return false;
+    }
+
+    *pte |= PTE_ACCESSED | (write ? PTE_DIRTY : 0);
+    virtual_memory.frames[*pte >> PAGE_SHIFT].referenced = true;
+    tlb_fill(pid, vpn, *pte);
+    return true;
+}
+
+// Tear down an address space and free its frames
+void vm_destroy(uint32_t pid) {
+    AddressSpace* space = &virtual_memory.spaces[pid - 1];
+
+    for (int t = 0; t < PTES_PER_TABLE; t++) {
+        if (space->tables[t] == NULL) {
+            continue;
+        }
+        for (int e = 0; e < PTES_PER_TABLE; e++) {
+            uint32_t pte = space->tables[t]->entries[e];
+            if ((pte & PTE_PRESENT) && --virtual_memory.frames[pte >> PAGE_SHIFT].map_count == 0) {
+                frame_release(pte >> PAGE_SHIFT);
+            }
+        }
+        free(space->tables[t]);
+        space->tables[t] = NULL;
+    }
+    space->resident_pages = 0;
+    tlb_flush_pid(pid);
+}
+
+// Security Tokens --------------------------------------------------------------------
+
+#define ROTL32(v, n) (((v) << (n)) | ((v) >> (32 - (n))))
+#define CHACHA_QUARTER_ROUND(a, b, c, d) \
+    a += b; d ^= a; d = ROTL32(d, 16);    \
+    c += d; b ^= c; b = ROTL32(b, 12);    \
+    a += b; d ^= a; d = ROTL32(d, 8);     \
+    c += d; b ^= c; b = ROTL32(b, 7);
+
+static void chacha20_block(const uint32_t input[16], uint8_t output[64]) {
+    uint32_t x[16];
+    memcpy(x, input, sizeof(x));
+
+    for (int round = 0; round < 10; round++) {
+        CHACHA_QUARTER_ROUND(x[0], x[4], x[8],  x[12]);
+        CHACHA_QUARTER_ROUND(x[1], x[5], x[9],  x[13]);
+        CHACHA_QUARTER_ROUND(x[2], x[6], x[10], x[14]);
+        CHACHA_QUARTER_ROUND(x[3], x[7], x[11], x[15]);
+        CHACHA_QUARTER_ROUND(x[0], x[5], x[10], x[15]);
+        CHACHA_QUARTER_ROUND(x[1], x[6], x[11], x[12]);
+        CHACHA_QUARTER_ROUND(x[2], x[7], x[8],  x[13]);
+        CHACHA_QUARTER_ROUND(x[3], x[4], x[9],  x[14]);
+    }
+    for (int i = 0; i < 16; i++) {
+        uint32_t word = x[i] + input[i];
+        output[i * 4] = (uint8_t)word;
+        output[i * 4 + 1] = (uint8_t)(word >> 8);
+        output[i * 4 + 2] = (uint8_t)(word >> 16);
+        output[i * 4 + 3] = (uint8_t)(word >> 24);
+    }
+}
+
+// Read seed material from the operating system
+static bool entropy_read(uint8_t* out, size_t length) {
+#if defined(__linux__)
+    size_t done = 0;
+    while (done < length) {
+        ssize_t got = getrandom(out + done, length - done, 0);
+        if (got <= 0) {
+            return false;
+        }
+        done += (size_t)got;
+    }
+    return true;
+#elif defined(_WIN32)
+    for (size_t i = 0; i < length; i += sizeof(unsigned int)) {
+        unsigned int value;
+        if (rand_s(&value) != 0) {
+            return false;
+        }
+        memcpy(out + i, &value, length - i < sizeof(value) ? length - i : sizeof(value));
+    }
+    return true;
+#else
+    FILE* source = fopen("/dev/urandom", "rb");
+    bool ok = source != NULL && fread(out, 1, length, source) == length;
+    if (source != NULL) {
+        fclose(source);
+    }
+    return ok;
+#endif
+}
+
+// Mix fresh entropy into the key, the first call also sets up the constants and nonce
+static bool csprng_reseed() {
+    uint32_t seed[12];
+    if (!entropy_read((uint8_t*)seed, sizeof(seed))) {
+        return false;
+    }
+
+    if (!csprng.is_seeded) {
+        csprng.state[0] = 0x61707865; // "expand 32-byte k"
+        csprng.state[1] = 0x3320646e;
+        csprng.state[2] = 0x79622d32;
+        csprng.state[3] = 0x6b206574;
+    }
+    for (int i = 0; i < 8; i++) {
+        csprng.state[4 + i] ^= seed[i];
+    }
+    csprng.state[12] = 0;
+    for (int i = 0; i < 3; i++) {
+        csprng.state[13 + i] = seed[8 + i];
+    }
+    memset(seed, 0, sizeof(seed));
+    csprng.available = 0;
+    csprng.bytes_since_reseed = 0;
+    csprng.is_seeded = true;
+    return true;
+}
+
+// Produce a batch of blocks, then replace the key with the first 32 bytes of it
+// so earlier output cannot be recomputed if the state leaks
+static void csprng_refill() {
+    for (int b = 0; b < CSPRNG_BATCH_BLOCKS; b++) {
+        chacha20_block(csprng.state, csprng.buffer + b * 64);
+        if (++csprng.state[12] == 0) {
+            csprng.state[13]++;
+        }
+    }
+    memcpy(&csprng.state[4], csprng.buffer, 32);
+    memset(csprng.buffer, 0, 32);
+    csprng.available = sizeof(csprng.buffer) - 32;
+}
+
+// Fill a buffer with cryptographically secure random bytes
+bool csprng_fill(uint8_t* out, size_t length) {
+    if ((!csprng.is_seeded || csprng.bytes_since_reseed >= CSPRNG_RESEED_BYTES) && !csprng_reseed()) {
+        return false;
+    }
+
+    while (length > 0) {
+        if (csprng.available == 0) {
+            csprng_refill();
+        }
+        size_t take = length < csprng.available ? length : csprng.available;
+        uint8_t* from = csprng.buffer + sizeof(csprng.buffer) - csprng.available;
+        memcpy(out, from, take);
+        memset(from, 0, take);   // Handed out bytes are never kept
+        csprng.available -= (uint32_t)take;
+        csprng.bytes_since_reseed += (uint32_t)take;
+        out += take;
+        length -= take;
+    }
+    return true;
+}
+
+// Compare tokens in time that does not depend on where they differ
+static bool token_equal(const uint8_t* a, const uint8_t* b) {
+    uint8_t difference = 0;
+    for (int i = 0; i < SECURITY_TOKEN_LENGTH; i++) {
+        difference |= a[i] ^ b[i];
+    }
+    return difference == 0;
+}
+
+// Tokens are uniformly random, so their first bytes are already a good hash
+static uint32_t token_slot(const uint8_t* token) {
+    uint32_t hash;
+    memcpy(&hash, token, sizeof(hash));
+    return hash & (TOKEN_TABLE_SIZE - 1);
+}
+
+static void token_table_remove(uint32_t pid) {
+    uint32_t slot = token_slot(mobile_kernel.processes[pid - 1].security_token.token);
+    while (token_table[slot] != pid) {
+        if (token_table[slot] == 0) {
+            return;
+        }
+        slot = (slot + 1) & (TOKEN_TABLE_SIZE - 1);
+    }
+
+    // Shift later entries of the probe run back so lookups never need tombstones
+    uint32_t hole = slot;
+    uint32_t next = (slot + 1) & (TOKEN_TABLE_SIZE - 1);
+    while (token_table[next] != 0) {
+        uint32_t home = token_slot(mobile_kernel.processes[token_table[next] - 1].security_token.token);
+        if (((next - home) & (TOKEN_TABLE_SIZE - 1)) >= ((next - hole) & (TOKEN_TABLE_SIZE - 1))) {
+            token_table[hole] = token_table[next];
+            hole = next;
+        }
+        next = (next + 1) & (TOKEN_TABLE_SIZE - 1);
+    }
+    token_table[hole] = 0;
+}
+
+// Give a process a fresh token, replacing any it already had
+bool token_issue(uint32_t pid) {
+    if (pid == 0 || pid > MAX_PROCESSES || mobile_kernel.processes[pid - 1].pid != pid) {
+        return false;
+    }
+
+    SecurityToken* token = &mobile_kernel.processes[pid - 1].security_token;
+    if (token->is_valid) {
+        token_table_remove(pid);
+        token->is_valid = false;
+    }
+    if (!csprng_fill(token->token, SECURITY_TOKEN_LENGTH)) {
+        return false;
+    }
+    token->creation_time = system_time();
+    token->is_valid = true;
+
+    uint32_t slot = token_slot(token->token);
+    while (token_table[slot] != 0) {
+        slot = (slot + 1) & (TOKEN_TABLE_SIZE - 1);
+    }
+    token_table[slot] = (uint16_t)pid;
+    metrics_count(COUNTER_TOKENS_MINTED, 1);
+    return true;
+}
+
+void token_revoke(uint32_t pid) {
+    if (pid == 0 || pid > MAX_PROCESSES || !mobile_kernel.processes[pid - 1].security_token.is_valid) {
+        return;
+    }
+    token_table_remove(pid);
+    memset(&mobile_kernel.processes[pid - 1].security_token, 0, sizeof(SecurityToken));
+}
+
+// Find the process a presented token belongs to
+// Returns the pid, or 0 if the token is unknown or older than TOKEN_LIFETIME_SECONDS
+uint32_t token_verify(const uint8_t token[SECURITY_TOKEN_LENGTH], uint32_t now) {
+    uint32_t slot = token_slot(token);
+    while (token_table[slot] != 0) {
+        uint32_t pid = token_table[slot];
+        const SecurityToken* candidate = &mobile_kernel.processes[pid - 1].security_token;
+        if (token_equal(candidate->token, token)) {
+            if (now - candidate->creation_time < TOKEN_LIFETIME_SECONDS) {
+                return pid;
+            }
+            break;
+        }
+        slot = (slot + 1) & (TOKEN_TABLE_SIZE - 1);
+    }
+    metrics_count(COUNTER_TOKENS_REJECTED, 1);
+    return 0;
+}
+
+// Account for a new process and announce it, pid 0 means creation failed
+static void process_created(uint32_t pid, uint64_t start) {
+    if (pid != 0) {
+        EnhancedProcessControlBlock* process = &mobile_kernel.processes[pid - 1];
+        metrics_count(COUNTER_PROCESSES_CREATED, 1);
+        token_issue(pid);
+        if (counts_as_runnable(process)) {
+            metrics_gauge_add(GAUGE_RUNNABLE_TASKS, 1);
+        }
+
+        KernelEvent* event = event_begin(EVENT_PROCESS_CREATED, pid, process->priority);
+        memcpy(event->process_name, process->process_name, sizeof(event->process_name));
+        event_commit();
+        if (process->power_state != POWER_FULL) {
+            publish_event(EVENT_POWER_STATE_CHANGED, pid, process->power_state);
+        }
+    } else {
+        metrics_count(COUNTER_PROCESS_CREATE_FAILED, 1); // Process creation failed
+    }
+    metrics_record_latency(HIST_PROCESS_CREATE, monotonic_ns() - start);
+}
+
+// CPU with the fewest processes placed on it, new normal tasks go there
+static uint8_t least_loaded_cpu() {
+    uint32_t load[MAX_CPUS] = {0};
+    uint8_t best = 0;
+
+    for (int i = 0; i < MAX_PROCESSES; i++) {
+        if (mobile_kernel.processes[i].pid != 0 && !mobile_kernel.processes[i].is_zygote) {
+            load[mobile_kernel.processes[i].cpu]++;
+        }
+    }
+    for (uint8_t cpu = 1; cpu < MAX_CPUS; cpu++) {
+        if (load[cpu] < load[best]) {
+            best = cpu;
+        }
+    }
+    return best;
+}
+
+// Process Creation with Permissions
+uint32_t create_process(
+    const char* process_name, 
+    uint8_t priority, 
+    AppPermission* required_permissions,
+    uint8_t permission_count
+) {
+    uint64_t start = monotonic_ns();
+    uint32_t pid = 0;
+
+    for (int i = 0; i < MAX_PROCESSES; i++) {
+        if (mobile_kernel.processes[i].pid == 0) {
+            // Initialize process
+            uint8_t cpu = least_loaded_cpu();
+            memset(&mobile_kernel.processes[i], 0, sizeof(EnhancedProcessControlBlock));
+            mobile_kernel.processes[i].pid = i + 1;
+            strncpy(mobile_kernel.processes[i].process_name, process_name, 31);
+            mobile_kernel.processes[i].priority = priority;
+            mobile_kernel.processes[i].sched_class = SCHED_CLASS_NORMAL;
+            mobile_kernel.processes[i].cpu = cpu;
+            mobile_kernel.processes[i].last_active_timestamp = system_time();
+            
+            // Set process permissions
             for (int j = 0; j < permission_count; j++) {
                 mobile_kernel.processes[i].permissions[required_permissions[j]] = true;
             }
             
-            return mobile_kernel.processes[i].pid;
+            pid = mobile_kernel.processes[i].pid;
+            break;
+        }
+    }
+
+    process_created(pid, start);
+    return pid;
+}
+
+// Deadline Scheduling -----------------------------------------------------------------
+
+// Share of one CPU a reservation needs, in 1/DL_BANDWIDTH_UNIT
+static uint32_t deadline_bandwidth(uint32_t runtime_us, uint32_t period_us) {
+    return (uint32_t)((uint64_t)runtime_us * DL_BANDWIDTH_UNIT / period_us);
+}
+
+// Start a new job of a deadline task: fresh budget and absolute deadline
+void deadline_release_job(uint32_t pid, uint64_t now_us) {
+    EnhancedProcessControlBlock* process = &mobile_kernel.processes[pid - 1];
+    process->dl.abs_deadline = now_us + process->dl.deadline_us;
+    process->dl.runtime_left = process->dl.runtime_us;
+    process->dl.next_release = now_us + process->dl.period_us;
+}
+
+// Move a process into the deadline class if some CPU can still guarantee it
+// Returns false if the parameters are invalid or every CPU is full (admission control)
+bool set_deadline_scheduling(uint32_t pid, uint32_t runtime_us, uint32_t period_us, uint32_t deadline_us) {
+    if (pid == 0 || pid > MAX_PROCESSES || mobile_kernel.processes[pid - 1].pid != pid) {
+        return false;
+    }
+    if (runtime_us == 0 || runtime_us > deadline_us || deadline_us > period_us) {
+        return false;
+    }
+
+    EnhancedProcessControlBlock* process = &mobile_kernel.processes[pid - 1];
+    uint32_t bandwidth = deadline_bandwidth(runtime_us, period_us);
+
+    // Partitioned EDF: first CPU with room keeps every deadline on it feasible
+    for (int cpu = 0; cpu < MAX_CPUS; cpu++) {
+        if (mobile_kernel.dl_bandwidth[cpu] + bandwidth <= DL_BANDWIDTH_LIMIT) {
+            if (process->sched_class == SCHED_CLASS_DEADLINE) {
+                mobile_kernel.dl_bandwidth[process->cpu] -= deadline_bandwidth(process->dl.runtime_us, process->dl.period_us);
+            }
+            mobile_kernel.dl_bandwidth[cpu] += bandwidth;
+
+            process->sched_class = SCHED_CLASS_DEADLINE;
+            process->cpu = (uint8_t)cpu;
+            process->dl.runtime_us = runtime_us;
+            process->dl.period_us = period_us;
+            process->dl.deadline_us = deadline_us;
+            deadline_release_job(pid, monotonic_ns() / 1000); // First job starts now
+            return true;
+        }
+    }
+    return false;
+}
+
+// Back to the normal class, releasing the reserved bandwidth
+void clear_deadline_scheduling(uint32_t pid) {
+    EnhancedProcessControlBlock* process = &mobile_kernel.processes[pid - 1];
+    if (process->sched_class == SCHED_CLASS_DEADLINE) {
+        mobile_kernel.dl_bandwidth[process->cpu] -= deadline_bandwidth(process->dl.runtime_us, process->dl.period_us);
+        process->sched_class = SCHED_CLASS_NORMAL;
+    }
+}
+
+// Charge CPU time to the running process
+void scheduler_account(uint32_t pid, uint32_t delta_us) {
+    EnhancedProcessControlBlock* process = &mobile_kernel.processes[pid - 1];
+    if (process->sched_class == SCHED_CLASS_DEADLINE) {
+        process->dl.runtime_left = process->dl.runtime_left > delta_us ? process->dl.runtime_left - delta_us : 0;
+    }
+}
+
+// Deadline the process is scheduled by, 0 if it is not in the deadline class at the moment
+static uint64_t effective_deadline(const EnhancedProcessControlBlock* process) {
+    uint64_t deadline = 0;
+    if (process->sched_class == SCHED_CLASS_DEADLINE && process->dl.runtime_left > 0) {
+        deadline = process->dl.abs_deadline;
+    }
+    if (process->pi_deadline != 0 && (deadline == 0 || process->pi_deadline < deadline)) {
+        deadline = process->pi_deadline;
+    }
+    return deadline;
+}
+
+static uint8_t effective_priority(const EnhancedProcessControlBlock* process) {
+    return process->pi_priority > process->priority ? process->pi_priority : process->priority;
+}
+
+// Pick the process to run on a CPU: earliest deadline first, then highest priority
+// runnable is indexed by pid - 1
+uint32_t pick_next_task(uint8_t cpu, const bool runnable[MAX_PROCESSES]) {
+    uint32_t best_dl = 0;
+    uint32_t best_normal = 0;
+
+    for (int i = 0; i < MAX_PROCESSES; i++) {
+        const EnhancedProcessControlBlock* process = &mobile_kernel.processes[i];
+        if (!runnable[i] || process->pid == 0 || process->cpu != cpu || process->power_state == POWER_SUSPEND) {
+            continue;
+        }
+
+        uint64_t deadline = effective_deadline(process);
+        if (deadline != 0) {
+            if (best_dl == 0 || deadline < effective_deadline(&mobile_kernel.processes[best_dl - 1])) {
+                best_dl = process->pid;
+            }
+        } else if (process->sched_class == SCHED_CLASS_NORMAL) {
+            // Throttled deadline tasks wait for their next release
+            if (best_normal == 0 || effective_priority(process) > effective_priority(&mobile_kernel.processes[best_normal - 1])) {
+                best_normal = process->pid;
+            }
+        }
+    }
+    return best_dl != 0 ? best_dl : best_normal;
+}
+
+// Recompute what the owner inherits from its waiters
+static void mutex_update_boost(KernelMutex* mutex) {
+    if (mutex->owner == 0) {
+        return;
+    }
+    EnhancedProcessControlBlock* owner = &mobile_kernel.processes[mutex->owner - 1];
+    owner->pi_priority = 0;
+    owner->pi_deadline = 0;
+    if (!mutex->priority_inheritance) {
+        return;
+    }
+
+    for (int i = 0; i < mutex->waiter_count; i++) {
+        const EnhancedProcessControlBlock* waiter = &mobile_kernel.processes[mutex->waiters[i] - 1];
+        uint64_t deadline = effective_deadline(waiter);
+        if (deadline != 0 && (owner->pi_deadline == 0 || deadline < owner->pi_deadline)) {
+            owner->pi_deadline = deadline;
+        }
+        if (effective_priority(waiter) > owner->pi_priority) {
+            owner->pi_priority = effective_priority(waiter);
+        }
+    }
+}
+
+// Take the mutex, or queue behind the owner and return false
+bool kernel_mutex_lock(KernelMutex* mutex, uint32_t pid) {
+    if (mutex->owner == 0 || mutex->owner == pid) {
+        mutex->owner = pid;
+        return true;
+    }
+    if (mutex->waiter_count < MAX_MUTEX_WAITERS) {
+        mutex->waiters[mutex->waiter_count++] = pid;
+    }
+    mutex_update_boost(mutex);
+    return false;
+}
+
+// Release the mutex and hand it to the most urgent waiter, returns the new owner (0 if none)
+uint32_t kernel_mutex_unlock(KernelMutex* mutex) {
+    if (mutex->owner != 0) {
+        mobile_kernel.processes[mutex->owner - 1].pi_priority = 0;
+        mobile_kernel.processes[mutex->owner - 1].pi_deadline = 0;
+    }
+    mutex->owner = 0;
+    if (mutex->waiter_count == 0) {
+        return 0;
+    }
+
+    int best = 0;
+    for (int i = 1; i < mutex->waiter_count; i++) {
+        const EnhancedProcessControlBlock* candidate = &mobile_kernel.processes[mutex->waiters[i] - 1];
+        const EnhancedProcessControlBlock* current = &mobile_kernel.processes[mutex->waiters[best] - 1];
+        uint64_t candidate_deadline = effective_deadline(candidate);
+        uint64_t current_deadline = effective_deadline(current);
+
+        if (candidate_deadline != 0 && (current_deadline == 0 || candidate_deadline < current_deadline)) {
+            best = i;
+        } else if (candidate_deadline == 0 && current_deadline == 0 &&
+                   effective_priority(candidate) > effective_priority(current)) {
+            best = i;
+        }
+    }
+
+    mutex->owner = mutex->waiters[best];
+    mutex->waiters[best] = mutex->waiters[--mutex->waiter_count];
+    mutex_update_boost(mutex);
+    return mutex->owner;
+}
+
+// Zygote Process Templates ------------------------------------------------------------
+
+// Share every resident page of parent with child copy-on-write
+static void vm_share_address_space(uint32_t parent_pid, uint32_t child_pid) {
+    AddressSpace* parent = &virtual_memory.spaces[parent_pid - 1];
+    AddressSpace* child = &virtual_memory.spaces[child_pid - 1];
+
+    for (int t = 0; t < PTES_PER_TABLE; t++) {
+        if (parent->tables[t] == NULL) {
+            continue;
+        }
+        child->tables[t] = calloc(1, sizeof(PageTable));
+        if (child->tables[t] == NULL) {
+            continue; // The child faults these pages in fresh
+        }
+
+        for (int e = 0; e < PTES_PER_TABLE; e++) {
+            uint32_t* pte = &parent->tables[t]->entries[e];
+            if (!(*pte & PTE_PRESENT)) {
+                continue; // Never touched, zygote pages are pinned and never swapped out
+            }
+
+            // Both sides lose write access until one of them writes
+            if (*pte & PTE_WRITABLE) {
+                *pte = (*pte & ~PTE_WRITABLE) | PTE_COW;
+                tlb_invalidate(parent_pid, (uint32_t)t * PTES_PER_TABLE + e);
+            }
+            child->tables[t]->entries[e] = *pte & ~(PTE_ACCESSED | PTE_DIRTY);
+
+            PhysicalFrame* frame = &virtual_memory.frames[*pte >> PAGE_SHIFT];
+            frame->map_count++;
+            frame->shared = true;
+            child->resident_pages++;
+        }
+    }
+    mobile_kernel.processes[child_pid - 1].memory_usage = child->resident_pages * PAGE_SIZE;
+}
+
+// Build a template process and fault in the pages every app starts with
+uint32_t create_zygote(const char* zygote_name, uint32_t preload_pages) {
+    uint32_t pid = create_process(zygote_name, 0, NULL, 0);
+    if (pid == 0) {
+        return 0;
+    }
+    // Templates are never scheduled and never authenticate, create_process counted and
+    // issued it like an app
+    metrics_gauge_add(GAUGE_RUNNABLE_TASKS, -1);
+    mobile_kernel.processes[pid - 1].is_zygote = true;
+    token_revoke(pid);
+
+    for (uint32_t page = 0; page < preload_pages; page++) {
+        if (!vm_access(pid, ZYGOTE_PRELOAD_BASE + page * PAGE_SIZE, true)) {
+            break;
+        }
+    }
+    return pid;
+}
+
+// Launch an app as a copy-on-write child of a zygote
+// Only the PCB and the page tables are new, data pages are copied when first written
+uint32_t fork_from_zygote(
+    uint32_t zygote_pid,
+    const char* process_name,
+    uint8_t priority,
+    AppPermission* required_permissions,
+    uint8_t permission_count
+) {
+    uint64_t start = monotonic_ns();
+    uint32_t pid = 0;
+
+    if (zygote_pid == 0 || zygote_pid > MAX_PROCESSES || !mobile_kernel.processes[zygote_pid - 1].is_zygote) {
+        return 0;
+    }
+
+    for (int i = 0; i < MAX_PROCESSES; i++) {
+        if (mobile_kernel.processes[i].pid == 0) {
+            // Inherit the template's state in one copy
+            uint8_t cpu = least_loaded_cpu();
+            mobile_kernel.processes[i] = mobile_kernel.processes[zygote_pid - 1];
+            mobile_kernel.processes[i].pid = i + 1;
+            mobile_kernel.processes[i].cpu = cpu;
+            mobile_kernel.processes[i].is_zygote = false;
+            mobile_kernel.processes[i].sched_class = SCHED_CLASS_NORMAL;
+            mobile_kernel.processes[i].pi_priority = 0;
+            memset(&mobile_kernel.processes[i].security_token, 0, sizeof(SecurityToken)); // Never share the template's token
+            mobile_kernel.processes[i].pi_deadline = 0;
+            mobile_kernel.processes[i].power_state = POWER_FULL;
+            mobile_kernel.processes[i].memory_usage = 0;
+            mobile_kernel.processes[i].last_background_run = 0;
+            strncpy(mobile_kernel.processes[i].process_name, process_name, 31);
+            mobile_kernel.processes[i].priority = priority;
+            mobile_kernel.processes[i].last_active_timestamp = system_time();
+
+            for (int j = 0; j < permission_count; j++) {
+                mobile_kernel.processes[i].permissions[required_permissions[j]] = true;
+            }
+
+            pid = i + 1;
+            break;
         }
     }
-    return 0; // Process creation failed
+
+    if (pid != 0) {
+        vm_share_address_space(zygote_pid, pid);
+    }
+    process_created(pid, start);
+    return pid;
+}
+
+// Process Termination
+bool terminate_process(uint32_t pid) {
+    if (pid == 0 || pid > MAX_PROCESSES || mobile_kernel.processes[pid - 1].pid != pid) {
+        return false;
+    }
+
+    if (counts_as_runnable(&mobile_kernel.processes[pid - 1])) {
+        metrics_gauge_add(GAUGE_RUNNABLE_TASKS, -1);
+    }
+    vm_destroy(pid);
+    clear_deadline_scheduling(pid);
+    sensor_unsubscribe_all(pid);
+    io_cancel_all(pid);
+    token_revoke(pid);
+    memset(&mobile_kernel.processes[pid - 1], 0, sizeof(EnhancedProcessControlBlock));
+    publish_event(EVENT_PROCESS_EXITED, pid, 0);
+    return true;
+}
+
+// Change Process Priority
+bool set_process_priority(uint32_t pid, uint8_t priority) {
+    if (pid == 0 || pid > MAX_PROCESSES || mobile_kernel.processes[pid - 1].pid != pid) {
+        return false;
+    }
+
+    if (mobile_kernel.processes[pid - 1].priority != priority) {
+        mobile_kernel.processes[pid - 1].priority = priority;
+        publish_event(EVENT_PRIORITY_CHANGED, pid, priority);
+    }
+    return true;
+}
+
+// Background Job Scheduler -----------------------------------------------------------
+
+void job_scheduler_init(bool coalesce) {
+    memset(&job_scheduler, 0, sizeof(JobScheduler));
+    job_scheduler.next_job_id = 1;
+    job_scheduler.coalesce = coalesce;
+    job_scheduler.conditions.network = true;
+}
+
+StandbyBucket standby_bucket(const EnhancedProcessControlBlock* process, uint32_t now) {
+    uint32_t idle_time = now - process->last_active_timestamp;
+    int bucket = BUCKET_ACTIVE;
+    while (bucket < BUCKET_RESTRICTED && idle_time >= standby_bucket_idle[bucket]) {
+        bucket++;
+    }
+    return (StandbyBucket)bucket;
+}
+
+// Submit background work that may run anywhere between earliest_time and deadline
+// Returns the job id, or 0 if the process may not run in the background
+uint32_t schedule_job(uint32_t pid, uint32_t earliest_time, uint32_t deadline, uint8_t constraints) {
+    if (pid == 0 || pid > MAX_PROCESSES || mobile_kernel.processes[pid - 1].pid != pid) {
+        return 0;
+    }
+    if (!mobile_kernel.processes[pid - 1].permissions[PERM_BACKGROUND_PROCESS] || deadline < earliest_time) {
+        return 0;
+    }
+
+    for (int i = 0; i < MAX_JOBS; i++) {
+        if (!job_scheduler.jobs[i].is_pending) {
+            BackgroundJob* job = &job_scheduler.jobs[i];
+            job->job_id = job_scheduler.next_job_id++;
+            job->pid = pid;
+            job->earliest_time = earliest_time;
+            job->deadline = deadline;
+            job->constraints = constraints;
+            job->is_pending = true;
+            return job->job_id;
+        }
+    }
+    return 0; // Job table full
+}
+
+bool job_is_pending(uint32_t job_id) {
+    for (int i = 0; i < MAX_JOBS; i++) {
+        if (job_scheduler.jobs[i].is_pending && job_scheduler.jobs[i].job_id == job_id) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool job_constraints_met(const BackgroundJob* job) {
+    const DeviceConditions* conditions = &job_scheduler.conditions;
+    if ((job->constraints & JOB_REQUIRES_CHARGING) && !conditions->charging) return false;
+    if ((job->constraints & JOB_REQUIRES_IDLE) && !conditions->idle) return false;
+    if ((job->constraints & JOB_REQUIRES_NETWORK) && !conditions->network) return false;
+    return true;
+}
+
+static bool job_bucket_allows(const BackgroundJob* job, uint32_t now) {
+    const EnhancedProcessControlBlock* process = &mobile_kernel.processes[job->pid - 1];
+    uint32_t interval = standby_bucket_interval[standby_bucket(process, now)];
+    return process->last_background_run == 0 || now - process->last_background_run >= interval;
+}
+
+// Earliest deadline among the jobs that may already run, 0 if there is none
+// Jobs held back by their standby bucket cannot run yet and do not count
+static uint32_t earliest_job_deadline(uint32_t now) {
+    uint32_t earliest = 0;
+    for (int i = 0; i < MAX_JOBS; i++) {
+        const BackgroundJob* job = &job_scheduler.jobs[i];
+        if (job->is_pending && job->earliest_time <= now && job_bucket_allows(job, now) &&
+            (earliest == 0 || job->deadline < earliest)) {
+            earliest = job->deadline;
+        }
+    }
+    return earliest;
+}
+
+// Start every job that is due at this point in time, returns how many were started
+// With coalescing the device only wakes up for maintenance windows and deadlines, and
+// jobs whose deadline falls before the next window are pulled into the current one
+uint32_t run_due_jobs(uint32_t now) {
+    uint32_t started = 0;
+    uint32_t horizon = now;
+
+    if (job_scheduler.coalesce) {
+        // Windows open on multiples of the window length, callers may step over the exact second
+        if (job_scheduler.next_window == 0) {
+            job_scheduler.next_window = (now + MAINTENANCE_WINDOW_SECONDS - 1) / MAINTENANCE_WINDOW_SECONDS *
+                                        MAINTENANCE_WINDOW_SECONDS;
+        }
+        if (now >= job_scheduler.next_window) {
+            job_scheduler.next_window = (now / MAINTENANCE_WINDOW_SECONDS + 1) * MAINTENANCE_WINDOW_SECONDS;
+            horizon = job_scheduler.next_window;
+        } else {
+            // Between windows only a reached deadline wakes the device
+            uint32_t deadline = earliest_job_deadline(now);
+            if (deadline == 0 || deadline > now) {
+                return 0;
+            }
+        }
+    }
+
+    for (int i = 0; i < MAX_JOBS; i++) {
+        BackgroundJob* job = &job_scheduler.jobs[i];
+        if (!job->is_pending || job->earliest_time > now) {
+            continue;
+        }
+
+        // An expired deadline overrides the constraints, but never the standby bucket
+        if (!job_bucket_allows(job, now) || (job->deadline > horizon && !job_constraints_met(job))) {
+            continue;
+        }
+
+        uint64_t delay = now - job->earliest_time;
+        histogram_record(&job_scheduler.delays, delay);
+        if (now > job->deadline) {
+            job_scheduler.deadline_misses++;
+        }
+
+        mobile_kernel.processes[job->pid - 1].last_background_run = now;
+        job->is_pending = false;
+        started++;
+    }
+
+    if (started > 0) {
+        job_scheduler.wakeups++;
+        metrics_count(COUNTER_JOB_WAKEUPS, 1);
+        metrics_count(COUNTER_JOBS_RUN, started);
+    }
+    return started;
 }
 
 // Security Token Generation
 void generate_security_token() {
-    // Genarate random values for security token 
-    // for real implementation, have to use cryptographically secure random generation
-    for (int i = 0; i < SECURITY_TOKEN_LENGTH; i++) {
-        mobile_kernel.system_token.token[i] = rand() % 256;
-    }
-    
+    // Genarate random values for security token from the ChaCha20 generator
+    mobile_kernel.system_token.is_valid = csprng_fill(mobile_kernel.system_token.token, SECURITY_TOKEN_LENGTH);
     mobile_kernel.system_token.creation_time = system_time();
-    mobile_kernel.system_token.is_valid = true;
 }
 
 // Memory Management with Adaptive Allocation
-uint32_t adaptive_memory_allocation(uint32_t requested_size) {
+static uint32_t allocate_memory(uint32_t requested_size) {
     // Implement intelligent memory allocation
     if (mobile_kernel.available_memory >= requested_size) {
         mobile_kernel.available_memory -= requested_size;
         return (uint32_t)malloc(requested_size);
     }
     
-    // If not enough memory, attempt to free low-priority process memory
+    // If not enough memory, reclaim pages (suspended processes go first) instead of whole processes
+    uint32_t shortfall = requested_size - mobile_kernel.available_memory;
+    metrics_count(COUNTER_MEMORY_RECLAIMS, 1);
+    reclaim_pages((shortfall + PAGE_SIZE - 1) / PAGE_SIZE);
+
+    // Check if we now have enough memory for the request
+    if (mobile_kernel.available_memory >= requested_size) {
+        mobile_kernel.available_memory -= requested_size;
+        return (uint32_t)malloc(requested_size); // Allocate memory
+    }
+    
+    return 0; // Memory allocation failed
+}
+
+uint32_t adaptive_memory_allocation(uint32_t requested_size) {
+    uint64_t start = monotonic_ns();
+    uint32_t address = allocate_memory(requested_size);
+
+    metrics_count(address != 0 ? COUNTER_MEMORY_ALLOCATIONS : COUNTER_MEMORY_ALLOC_FAILED, 1);
+    metrics_gauge_set(GAUGE_AVAILABLE_MEMORY, mobile_kernel.available_memory);
+    metrics_record_latency(HIST_MEMORY_ALLOCATION, monotonic_ns() - start);
+    return address;
+}
+
+// Headless Monitor ----------------------------------------------------------------
+// A front-end without a GUI that mirrors kernel state from the event stream
+
+typedef struct {
+    bool present;
+    char process_name[32];
+    uint8_t priority;
+    PowerManagementState power_state;
+} MonitorProcess;
+
+typedef struct {
+    bool is_active;
+    SensorType type;
+    uint16_t sampling_rate;
+} MonitorSensor;
+
+typedef struct {
+    EventSubscriber subscriber;
+    MonitorProcess processes[MAX_PROCESSES];
+    MonitorSensor sensors[MAX_SENSORS];
+    PowerManagementState power_mode;
+    uint32_t events_applied;
+    uint32_t resyncs;
+} HeadlessMonitor;
+
+// Full scan of the kernel tables, only used on attach and after an overrun
+void monitor_resync(HeadlessMonitor* monitor) {
+    memset(monitor->processes, 0, sizeof(monitor->processes));
+    memset(monitor->sensors, 0, sizeof(monitor->sensors));
+
     for (int i = 0; i < MAX_PROCESSES; i++) {
-        if (mobile_kernel.processes[i].power_state == POWER_SUSPEND) {
-            // Logic to reclaim memory
-            uint32_t process_memory = mobile_kernel.processes[i].memory_usage;
-            if (process_memory > 0) {
-                // Free process memory
-                free((void*)mobile_kernel.processes[i].memory_usage);
-                mobile_kernel.available_memory += process_memory;
-                mobile_kernel.processes[i].memory_usage = 0;
-
-                // Check if we now have enough memory for the request
-                if (mobile_kernel.available_memory >= requested_size) {
-                    mobile_kernel.available_memory -= requested_size;
-                    return (uint32_t)malloc(requested_size); // Allocate memory
-                }
-            }
+        if (mobile_kernel.processes[i].pid != 0) {
+            monitor->processes[i].present = true;
+            memcpy(monitor->processes[i].process_name, mobile_kernel.processes[i].process_name,
+                   sizeof(monitor->processes[i].process_name));
+            monitor->processes[i].priority = mobile_kernel.processes[i].priority;
+            monitor->processes[i].power_state = mobile_kernel.processes[i].power_state;
+        }
+    }
+    for (int i = 0; i < MAX_SENSORS; i++) {
+        monitor->sensors[i].is_active = mobile_kernel.sensors[i].is_active;
+        monitor->sensors[i].type = mobile_kernel.sensors[i].type;
+        monitor->sensors[i].sampling_rate = mobile_kernel.sensors[i].sampling_rate;
+    }
+    monitor->power_mode = mobile_kernel.current_power_mode;
+    monitor->resyncs++;
+}
+
+void monitor_attach(HeadlessMonitor* monitor) {
+    memset(monitor, 0, sizeof(HeadlessMonitor));
+    event_subscribe(&monitor->subscriber);
+    monitor_resync(monitor);
+}
+
+void monitor_apply(HeadlessMonitor* monitor, const KernelEvent* event) {
+    MonitorProcess* process = NULL;
+    if (event->id >= 1 && event->id <= MAX_PROCESSES) {
+        process = &monitor->processes[event->id - 1];
+    }
+
+    switch (event->type) {
+        case EVENT_PROCESS_CREATED:
+            memset(process, 0, sizeof(MonitorProcess));
+            process->present = true;
+            memcpy(process->process_name, event->process_name, sizeof(process->process_name));
+            process->priority = (uint8_t)event->value;
+            process->power_state = POWER_FULL;
+            break;
+
+        case EVENT_PROCESS_EXITED:
+            memset(process, 0, sizeof(MonitorProcess));
+            break;
+
+        case EVENT_PRIORITY_CHANGED:
+            process->priority = (uint8_t)event->value;
+            break;
+
+        case EVENT_POWER_STATE_CHANGED:
+            process->power_state = (PowerManagementState)event->value;
+            break;
+
+        case EVENT_SENSOR_ADDED:
+            monitor->sensors[event->id].is_active = true;
+            monitor->sensors[event->id].type = event->sensor_type;
+            monitor->sensors[event->id].sampling_rate = (uint16_t)event->value;
+            break;
+
+        case EVENT_SENSOR_RATE_CHANGED:
+            monitor->sensors[event->id].sampling_rate = (uint16_t)event->value;
+            break;
+
+        case EVENT_POWER_MODE_CHANGED:
+            monitor->power_mode = (PowerManagementState)event->value;
+            break;
+
+        case EVENT_RESYNC:
+            monitor_resync(monitor);
+            break;
+    }
+    monitor->events_applied++;
+}
+
+// Drain pending events, cost is proportional to what changed
+void monitor_update(HeadlessMonitor* monitor) {
+    KernelEvent batch[32];
+    uint32_t count;
+
+    while ((count = event_poll(&monitor->subscriber, batch, 32)) > 0) {
+        for (uint32_t i = 0; i < count; i++) {
+            monitor_apply(monitor, &batch[i]);
+        }
+    }
+}
+
+// Compare the mirrored state with the kernel tables
+bool monitor_matches_kernel(const HeadlessMonitor* monitor) {
+    for (int i = 0; i < MAX_PROCESSES; i++) {
+        const EnhancedProcessControlBlock* pcb = &mobile_kernel.processes[i];
+        const MonitorProcess* mirror = &monitor->processes[i];
+        if (mirror->present != (pcb->pid != 0)) {
+            return false;
+        }
+        if (mirror->present &&
+            (strcmp(mirror->process_name, pcb->process_name) != 0 ||
+             mirror->priority != pcb->priority ||
+             mirror->power_state != pcb->power_state)) {
+            return false;
+        }
+    }
+    for (int i = 0; i < MAX_SENSORS; i++) {
+        if (monitor->sensors[i].is_active != mobile_kernel.sensors[i].is_active) {
+            return false;
+        }
+        if (monitor->sensors[i].is_active &&
+            (monitor->sensors[i].type != mobile_kernel.sensors[i].type ||
+             monitor->sensors[i].sampling_rate != mobile_kernel.sensors[i].sampling_rate)) {
+            return false;
         }
     }
-    
-    return 0; // Memory allocation failed
+    return monitor->power_mode == mobile_kernel.current_power_mode;
 }
 
 // Simulations ------------------------------------------------------------------
 
 // Creating multiple processes
 void create_multiple_processes() {
-    AppPermission perms1[] = {PERM_LOCATION, PERM_NETWORK};
-    create_process("NavigationApp", 8, perms1, 2);
+    AppPermission perms1[] = {PERM_LOCATION, PERM_NETWORK, PERM_SENSORS};
+    create_process("NavigationApp", 8, perms1, 3);
 
     AppPermission perms2[] = {PERM_CAMERA, PERM_STORAGE};
     create_process("CameraApp", 5, perms2, 2);
@@ -231,38 +2737,90 @@ void create_multiple_processes() {
 // Simulate sensor activity
 void simulate_sensor_activity() {
     for (int i = 0; i < MAX_SENSORS; i++) {
-        if (mobile_kernel.sensors[i].is_active) {
+        if (mobile_kernel.sensors[i].is_active && mobile_kernel.sensors[i].sampling_rate > 0) {
             // Populate the data buffer with randome numbers
-            int* data = (int*)mobile_kernel.sensors[i].data_buffer;
-            for (int j = 0; j < 10; j++) {  // Simulating 10 readings
-                data[j] = rand() % 100;  // Random values between 0 and 99
-            }
-
-            // Print simulated data
             printf("Sensor Type %d - Simulated Data: ", mobile_kernel.sensors[i].type);
-            for (int j = 0; j < 10; j++) {
-                printf("%d ", data[j]);
+            for (int j = 0; j < 10; j++) {  // Simulating 10 readings
+                int32_t value = rand() % 100;  // Random values between 0 and 99
+                sensor_push_sample(i, value);
+                printf("%d ", value);
             }
             printf("\n");
         }
     }
+
+    // Deliver the readings to subscribers
+    for (int i = 0; i < MAX_SENSOR_SUBSCRIPTIONS; i++) {
+        SensorBatch batch;
+        if (sensor_subscriptions[i].is_active && sensor_poll((uint32_t)i + 1, &batch) > 0) {
+            printf("%s received %u samples from Sensor Type %d\n",
+                   mobile_kernel.processes[sensor_subscriptions[i].pid - 1].process_name, batch.count,
+                   mobile_kernel.sensors[sensor_subscriptions[i].sensor_slot].type);
+        }
+    }
 }
 
 // Simulating process sheduler
 void simulate_scheduler() {
     printf("Simulating process scheduler...\n");
+    uint64_t start = monotonic_ns();
+    bool cpu_busy[MAX_CPUS] = {false};
+    bool runnable[MAX_PROCESSES] = {false};
+    bool deferred_only[MAX_PROCESSES] = {false};
+
+    uint32_t now = system_time();
+    uint64_t now_us = monotonic_ns() / 1000;
+
+    // Start the deferred jobs that are due, their apps get to run in this pass
+    uint32_t jobs_started = run_due_jobs(now);
+    if (jobs_started > 0) {
+        printf("Started %u deferred background jobs\n", jobs_started);
+    }
 
     for (int i = 0; i < MAX_PROCESSES; i++) {
         if (mobile_kernel.processes[i].pid != 0) {
-            printf("Running Process PID: %u, Name: %s, Priority: %u\n",
-                   mobile_kernel.processes[i].pid,
-                   mobile_kernel.processes[i].process_name,
-                   mobile_kernel.processes[i].priority);
+            // Zygotes are templates, background apps outside the active bucket only run through deferred jobs
+            if (mobile_kernel.processes[i].is_zygote) {
+                continue;
+            }
+            // Deadline tasks get a new job and a full budget at each period boundary,
+            // periods that passed between scheduler passes are not made up
+            if (mobile_kernel.processes[i].sched_class == SCHED_CLASS_DEADLINE &&
+                now_us >= mobile_kernel.processes[i].dl.next_release) {
+                deadline_release_job(mobile_kernel.processes[i].pid, now_us);
+            }
+            deferred_only[i] = mobile_kernel.processes[i].permissions[PERM_BACKGROUND_PROCESS] &&
+                               standby_bucket(&mobile_kernel.processes[i], now) != BUCKET_ACTIVE;
+            runnable[i] = !deferred_only[i] || mobile_kernel.processes[i].last_background_run == now;
+        }
+    }
 
-            // Simulate some work
-            mobile_kernel.processes[i].last_active_timestamp = system_time();
+    // Each CPU runs its tasks once, deadline tasks first, then by priority
+    for (uint8_t cpu = 0; cpu < MAX_CPUS; cpu++) {
+        current_cpu = cpu;
+        uint32_t pid;
+        while ((pid = pick_next_task(cpu, runnable)) != 0) {
+            EnhancedProcessControlBlock* process = &mobile_kernel.processes[pid - 1];
+            runnable[pid - 1] = false;
+            cpu_busy[cpu] = true;
+            metrics_count(COUNTER_CONTEXT_SWITCHES, 1);
+
+            printf("Running Process PID: %u, Name: %s, Priority: %u, CPU: %u\n",
+                   process->pid, process->process_name, process->priority, cpu);
+
+            // Simulate some work, running a deferred job does not count as use of the app
+            if (!deferred_only[pid - 1]) {
+                process->last_active_timestamp = now;
+            }
+            // The job runs to completion, the task is throttled until its next release
+            scheduler_account(pid, process->dl.runtime_left);
         }
     }
+
+    current_cpu = 0;
+    governor_tick(cpu_busy);
+    metrics_count(COUNTER_SCHEDULER_PASSES, 1);
+    metrics_record_latency(HIST_SCHEDULER_PASS, monotonic_ns() - start);
 }
 
 // Simulate power state transitions
@@ -296,10 +2854,828 @@ void test_power_state_transitions() {
     }
 }
 
+// Store and read back a photo through the asynchronous I/O path
+void simulate_storage_activity() {
+    static uint8_t photo[3 * IO_BLOCK_SIZE];
+    static uint8_t readback[3 * IO_BLOCK_SIZE];
+    IoCompletion completion;
+
+    printf("\nSimulating storage I/O...\n");
+    for (size_t i = 0; i < sizeof(photo); i++) {
+        photo[i] = (uint8_t)(rand() % 256);
+    }
+
+    // CameraApp holds PERM_STORAGE, NavigationApp does not
+    printf("NavigationApp write: %s\n", io_submit(1, IO_WRITE, 0, 3, photo) ? "queued" : "denied");
+    uint32_t write_id = io_submit(2, IO_WRITE, 16, 3, photo);
+    io_advance(storage.now_us + 1000);
+    uint32_t read_id = io_submit(2, IO_READ, 16, 3, readback);
+    io_advance(storage.now_us + 1000);
+
+    while (io_reap(&completion)) {
+        printf("Request %u (%s) for PID %u: %d bytes in %llu us\n", completion.id,
+               completion.id == write_id ? "write" : completion.id == read_id ? "read" : "other",
+               completion.pid, completion.result, (unsigned long long)completion.latency_us);
+    }
+    printf("Read back matches: %s\n", memcmp(photo, readback, sizeof(photo)) == 0 ? "yes" : "no");
+}
+
+// Fan one accelerometer out to subscribers at different rates
+void test_sensor_fanout() {
+    AppPermission perms[] = {PERM_SENSORS};
+    AppPermission no_perms[] = {PERM_NETWORK};
+    uint16_t rates[] = {50, 25, 10};
+    uint32_t pids[3];
+    uint32_t subs[3];
+    int slot = -1;
+
+    printf("\nSensor fan-out...\n");
+    for (int i = 0; i < MAX_SENSORS && slot < 0; i++) {
+        if (mobile_kernel.sensors[i].is_active && mobile_kernel.sensors[i].type == SENSOR_ACCELEROMETER) {
+            slot = i;
+        }
+    }
+    if (slot < 0) {
+        return;
+    }
+    PowerManagementState saved_mode = mobile_kernel.current_power_mode;
+    power_management(POWER_FULL);
+
+    for (int i = 0; i < 3; i++) {
+        char name[32];
+        sprintf(name, "MotionApp%d", i);
+        pids[i] = create_process(name, 4, perms, 1);
+        subs[i] = sensor_subscribe(pids[i], SENSOR_ACCELEROMETER, rates[i]);
+    }
+    printf("Accelerometer rate with %u subscribers: %u Hz\n",
+           mobile_kernel.sensors[slot].subscriber_count, mobile_kernel.sensors[slot].sampling_rate);
+
+    uint32_t intruder = create_process("NoSensorApp", 4, no_perms, 1);
+    printf("Subscription without PERM_SENSORS: %s\n",
+           sensor_subscribe(intruder, SENSOR_ACCELEROMETER, 50) ? "granted" : "denied");
+    terminate_process(intruder);
+
+    // One second of samples
+    for (int i = 0; i < mobile_kernel.sensors[slot].sampling_rate; i++) {
+        sensor_push_sample(slot, rand() % 100);
+    }
+    for (int i = 0; i < 3; i++) {
+        SensorBatch batch;
+        uint32_t count = sensor_poll(subs[i], &batch);
+        printf("%s (%u Hz): %u samples, first %d, shared buffer %s\n",
+               mobile_kernel.processes[pids[i] - 1].process_name, rates[i], count,
+               count ? sensor_batch_sample(&batch, 0) : 0,
+               batch.ring == mobile_kernel.sensors[slot].data_buffer ? "yes" : "no");
+    }
+
+    // 11 samples is not a multiple of any decimation, a second poll must find nothing new
+    bool partial_ok = true;
+    for (int i = 0; i < 11; i++) {
+        sensor_push_sample(slot, rand() % 100);
+    }
+    for (int i = 0; i < 3; i++) {
+        SensorBatch batch;
+        uint32_t decimation = sensor_subscriptions[subs[i] - 1].decimation;
+        uint32_t first = sensor_poll(subs[i], &batch);
+        uint32_t again = sensor_poll(subs[i], &batch);
+        partial_ok = partial_ok && first == 11 / decimation && again == 0;
+    }
+    printf("Partial batch check: %s\n", partial_ok ? "PASSED" : "FAILED");
+
+    // Subscribing again keeps the one subscription and only changes its rate
+    uint32_t subscribers = mobile_kernel.sensors[slot].subscriber_count;
+    bool resubscribe_ok = sensor_subscribe(pids[2], SENSOR_ACCELEROMETER, 25) == subs[2] &&
+                          mobile_kernel.sensors[slot].subscriber_count == subscribers &&
+                          sensor_subscriptions[subs[2] - 1].requested_rate == 25;
+    printf("Resubscribe check: %s\n", resubscribe_ok ? "PASSED" : "FAILED");
+
+    sensor_unsubscribe(subs[0]);
+    printf("After the 50 Hz subscriber leaves: %u Hz\n", mobile_kernel.sensors[slot].sampling_rate);
+    for (int i = 0; i < 3; i++) {
+        terminate_process(pids[i]);
+    }
+    printf("After the demo apps exit: %u Hz (%u subscribers left)\n", mobile_kernel.sensors[slot].sampling_rate,
+           mobile_kernel.sensors[slot].subscriber_count);
+
+    power_management(saved_mode);
+}
+
+// Verify that applying event deltas reconstructs the full kernel state
+void test_event_stream_reconstruction() {
+    HeadlessMonitor monitor;
+    AppPermission perms[] = {PERM_SENSORS};
+    PowerManagementState saved_mode = mobile_kernel.current_power_mode;
+    uint32_t created[MAX_PROCESSES];
+    int created_count = 0;
+    int sensors_added = 0;
+    bool consistent = true;
+
+    printf("\nVerifying event stream reconstruction...\n");
+    monitor_attach(&monitor);
+
+    for (int round = 0; round < 500; round++) {
+        // Only touch processes this test created
+        int victim = created_count > 0 ? rand() % created_count : -1;
+
+        switch (rand() % 6) {
+            case 0:
+            case 1: {
+                uint32_t pid = create_process("MonitoredApp", (uint8_t)(rand() % 10), perms, 1);
+                if (pid != 0) {
+                    created[created_count++] = pid;
+                }
+                break;
+            }
+            case 2:
+                if (victim >= 0) {
+                    terminate_process(created[victim]);
+                    created[victim] = created[--created_count];
+                }
+                break;
+            case 3:
+                if (victim >= 0) {
+                    set_process_priority(created[victim], (uint8_t)(rand() % 10));
+                }
+                break;
+            case 4:
+                if (sensors_added < 3 && register_sensor((SensorType)(rand() % 7), (uint16_t)(rand() % 100))) {
+                    sensors_added++;
+                }
+                break;
+            case 5:
+                power_management((PowerManagementState)(rand() % 4));
+                break;
+        }
+
+        // Poll at irregular intervals, with a stalled front-end in the middle that overruns the queue
+        bool stalled = round >= 150 && round < 350;
+        if (!stalled && rand() % 8 == 0) {
+            monitor_update(&monitor);
+            consistent = consistent && monitor_matches_kernel(&monitor);
+        }
+    }
+
+    // Clean up and check once more after the teardown events
+    for (int i = 0; i < created_count; i++) {
+        terminate_process(created[i]);
+    }
+    power_management(saved_mode);
+    monitor_update(&monitor);
+    consistent = consistent && monitor_matches_kernel(&monitor);
+
+    printf("Event stream check: %s (%u events applied, %u resyncs)\n",
+           consistent ? "PASSED" : "FAILED", monitor.events_applied, monitor.resyncs);
+}
+
+// A deadline task gets its first job on admission and the scheduler pass runs it
+void test_deadline_release() {
+    AppPermission perms[] = {PERM_SENSORS};
+    uint32_t pid = create_process("FrameTimer", 3, perms, 1);
+    const DeadlineParams* dl = &mobile_kernel.processes[pid - 1].dl;
+
+    bool released = set_deadline_scheduling(pid, 2000, 16000, 16000) && dl->runtime_left == dl->runtime_us;
+    simulate_scheduler();
+    bool ran = released && dl->runtime_left == 0;
+
+    printf("Deadline release check: %s\n", ran ? "PASSED" : "FAILED");
+    terminate_process(pid);
+}
+
+// Replay a fixed workload under each governor policy and report energy versus latency
+typedef struct {
+    uint32_t arrival_tick;
+    uint32_t work_kcycles;   // At f MHz a CPU retires f kcycles per tick
+    uint32_t remaining_kcycles;
+} WorkloadTask;
+
+static uint32_t build_governor_workload(WorkloadTask* tasks, uint32_t max_tasks) {
+    uint32_t count = 0;
+    uint32_t seed = 12345;
+
+    for (uint32_t tick = 0; tick < 10000 && count < max_tasks; tick++) {
+        uint32_t work = 0;
+        seed = seed * 1103515245 + 12345; // Fixed LCG so every policy replays the same trace
+
+        if (tick < 2000 || tick >= 8000) {
+            // Interactive: one frame every 16 ms
+            if (tick % 16 == 0) work = 6000 + (seed >> 16) % 4000;
+        } else if (tick < 5000) {
+            // Sustained heavy load
+            if (tick % 5 == 0) work = 30000 + (seed >> 16) % 20000;
+        } else {
+            // Mostly idle, periodic sync
+            if (tick % 100 == 0) work = 1000;
+        }
+
+        if (work > 0) {
+            tasks[count].arrival_tick = tick;
+            tasks[count].work_kcycles = work;
+            tasks[count].remaining_kcycles = work;
+            count++;
+        }
+    }
+    return count;
+}
+
+void benchmark_governor_policies() {
+    static WorkloadTask tasks[1024];
+    static LatencyHistogram latencies;
+    PowerManagementState saved_mode = mobile_kernel.current_power_mode;
+    uint32_t task_count = build_governor_workload(tasks, 1024);
+
+    printf("\nGovernor benchmark: %u tasks over 10 s on %d CPUs\n", task_count, MAX_CPUS);
+    printf("%-12s %10s %8s %8s %8s %9s %12s %8s\n",
+           "policy", "energy_mJ", "avg_ms", "p95_ms", "p99_ms", "max_temp", "throttled_ms", "switches");
+
+    for (int policy = 0; policy < GOVERNOR_POLICY_COUNT; policy++) {
+        uint32_t next_arrival = 0;
+        uint32_t head[MAX_CPUS] = {0};   // Oldest unfinished task per CPU
+        uint32_t completed = 0;
+        uint64_t energy_uj = 0;
+        double max_temp = THERMAL_AMBIENT;
+
+        for (uint32_t i = 0; i < task_count; i++) {
+            tasks[i].remaining_kcycles = tasks[i].work_kcycles;
+        }
+        memset(&latencies, 0, sizeof(LatencyHistogram));
+        power_management(policy == GOVERNOR_POWERSAVE ? POWER_BATTERY_SAVE : POWER_FULL);
+        governor_init((GovernorPolicy)policy);
+
+        for (uint32_t tick = 0; completed < task_count && tick < 120000; tick++) {
+            bool cpu_busy[MAX_CPUS] = {false};
+
+            while (next_arrival < task_count && tasks[next_arrival].arrival_tick <= tick) {
+                next_arrival++;
+            }
+
+            // Task i always runs on CPU i % MAX_CPUS, in arrival order
+            for (int cpu = 0; cpu < MAX_CPUS; cpu++) {
+                uint32_t budget = governor_cpu_freq(cpu);
+                while (budget > 0) {
+                    uint32_t index = head[cpu] * MAX_CPUS + cpu;
+                    if (index >= next_arrival) {
+                        break;
+                    }
+                    WorkloadTask* task = &tasks[index];
+                    uint32_t step = task->remaining_kcycles < budget ? task->remaining_kcycles : budget;
+                    task->remaining_kcycles -= step;
+                    budget -= step;
+                    cpu_busy[cpu] = true;
+                    if (task->remaining_kcycles == 0) {
+                        uint64_t latency = tick + 1 - task->arrival_tick;
+                        histogram_record(&latencies, latency);
+                        head[cpu]++;
+                        completed++;
+                    }
+                }
+            }
+
+            energy_uj += governor_tick(cpu_busy); // mW over 1 ms = uJ
+            if (cpu_governor.temperature > max_temp) {
+                max_temp = cpu_governor.temperature;
+            }
+        }
+
+        printf("%-12s %10llu %8llu %8llu %8llu %9.1f %12u %8u\n",
+               governor_names[policy],
+               (unsigned long long)(energy_uj / 1000),
+               (unsigned long long)(latencies.count ? latencies.sum / latencies.count : 0),
+               (unsigned long long)histogram_percentile(&latencies, 95.0),
+               (unsigned long long)histogram_percentile(&latencies, 99.0),
+               max_temp,
+               cpu_governor.throttled_ticks,
+               cpu_governor.mode_switches);
+    }
+
+    // Back to the normal kernel governor
+    power_management(saved_mode);
+    governor_init(GOVERNOR_SCHEDUTIL);
+}
+
+// Run a day of periodic background jobs from many apps with and without coalescing
+void benchmark_job_coalescing() {
+    const int app_count = 24;
+    const uint32_t day = 24 * 3600;
+    uint32_t pids[24];
+    uint32_t jobs[24];
+    uint32_t next_submit[24];
+    uint32_t base = system_time() / 3600 * 3600; // Start on an hour so windows line up
+    AppPermission perms[] = {PERM_BACKGROUND_PROCESS, PERM_NETWORK};
+
+    printf("\nBackground job benchmark: %d apps, 24 h simulated\n", app_count);
+    printf("%-14s %10s %12s %10s %10s %10s %8s\n",
+           "mode", "jobs_run", "wakeups/h", "p50_delay", "p95_delay", "max_delay", "misses");
+
+    for (int app = 0; app < app_count; app++) {
+        char name[32];
+        sprintf(name, "SyncApp%d", app);
+        pids[app] = create_process(name, 2, perms, 2);
+    }
+
+    for (int coalesce = 0; coalesce <= 1; coalesce++) {
+        job_scheduler_init(coalesce);
+
+        for (int app = 0; app < app_count; app++) {
+            if (pids[app] == 0) continue;
+            // Spread the apps over every standby bucket
+            mobile_kernel.processes[pids[app] - 1].last_active_timestamp = base - (uint32_t)(app % 5) * 3 * 3600;
+            mobile_kernel.processes[pids[app] - 1].last_background_run = 0;
+            jobs[app] = 0;
+            next_submit[app] = base + (uint32_t)app * 37; // Stagger the first submissions
+        }
+
+        for (uint32_t now = base; now < base + day; now += 60) {
+            uint32_t hour = (now - base) / 3600;
+
+            // Charging and idle overnight, no network over lunch
+            job_scheduler.conditions.charging = hour < 7;
+            job_scheduler.conditions.idle = hour < 7;
+            job_scheduler.conditions.network = hour != 12;
+
+            for (int app = 0; app < app_count; app++) {
+                if (pids[app] == 0 || job_is_pending(jobs[app]) || now < next_submit[app]) continue;
+
+                // Periods from 15 minutes to 2 hours, flex as long as the period except for
+                // every fourth app, whose 5 minute flex is shorter than a maintenance window
+                uint32_t period = (15 + (uint32_t)(app % 8) * 15) * 60;
+                uint32_t flex = app % 4 == 3 ? 5 * 60 : period;
+                uint8_t constraints = JOB_REQUIRES_NETWORK | (app % 6 == 0 ? JOB_REQUIRES_CHARGING : 0);
+                jobs[app] = schedule_job(pids[app], now + period, now + period + flex, constraints);
+                next_submit[app] = now + period;
+            }
+
+            run_due_jobs(now);
+        }
+
+        // Misses left with coalescing match the uncoalesced run, they come from standby buckets
+
+        printf("%-14s %10llu %12.1f %9llus %9llus %9llus %8u\n",
+               coalesce ? "coalesced" : "uncoalesced",
+               (unsigned long long)job_scheduler.delays.count,
+               job_scheduler.wakeups / 24.0,
+               (unsigned long long)histogram_percentile(&job_scheduler.delays, 50.0),
+               (unsigned long long)histogram_percentile(&job_scheduler.delays, 95.0),
+               (unsigned long long)job_scheduler.delays.max,
+               job_scheduler.deadline_misses);
+    }
+
+    for (int app = 0; app < app_count; app++) {
+        terminate_process(pids[app]);
+    }
+    job_scheduler_init(true);
+}
+
+// Page fault handling rate and TLB hit rate for sequential and random access
+void benchmark_virtual_memory() {
+    const uint32_t region_pages = 4096;          // 16 MB working set
+    const uint32_t accesses = 1 << 20;
+    AppPermission perms[] = {PERM_STORAGE};
+    uint32_t seed = 42;
+
+    printf("\nVirtual memory benchmark: %u accesses over %u KB\n", accesses, region_pages * PAGE_SIZE / 1024);
+    printf("%-12s %8s %14s %10s %10s\n", "pattern", "faults", "faults/s", "p99_ns", "tlb_hit%");
+
+    for (int pattern = 0; pattern < 2; pattern++) {
+        uint32_t pid = create_process(pattern == 0 ? "SeqWorker" : "RandWorker", 3, perms, 1);
+        uint64_t faults_before = metrics_counter_total(COUNTER_PAGE_FAULTS);
+        uint64_t hits_before = metrics_counter_total(COUNTER_TLB_HITS);
+        uint64_t misses_before = metrics_counter_total(COUNTER_TLB_MISSES);
+        LatencyHistogram before;
+        LatencyHistogram after;
+        metrics_histogram_snapshot(HIST_PAGE_FAULT, &before);
+
+        for (uint32_t i = 0; i < accesses; i++) {
+            uint32_t offset;
+            if (pattern == 0) {
+                offset = (i * 64) % (region_pages * PAGE_SIZE);   // One cache line after another
+            } else {
+                seed = seed * 1103515245 + 12345;
+                offset = (seed >> 4) % (region_pages * PAGE_SIZE);
+            }
+            vm_access(pid, 0x10000000 + offset, i % 4 == 0);
+        }
+
+        metrics_histogram_snapshot(HIST_PAGE_FAULT, &after);
+        uint64_t faults = metrics_counter_total(COUNTER_PAGE_FAULTS) - faults_before;
+        uint64_t hits = metrics_counter_total(COUNTER_TLB_HITS) - hits_before;
+        uint64_t misses = metrics_counter_total(COUNTER_TLB_MISSES) - misses_before;
+        uint64_t fault_ns = after.sum - before.sum;
+
+        // Only the faults of this run in the tail estimate
+        for (int b = 0; b < HIST_BUCKETS; b++) {
+            after.buckets[b] -= before.buckets[b];
+        }
+        after.count -= before.count;
+
+        printf("%-12s %8llu %14.0f %10llu %9.2f%%\n",
+               pattern == 0 ? "sequential" : "random",
+               (unsigned long long)faults,
+               fault_ns ? faults * 1e9 / fault_ns : 0.0,
+               (unsigned long long)histogram_percentile(&after, 99.0),
+               100.0 * hits / (hits + misses));
+
+        terminate_process(pid);
+    }
+
+    // Memory pressure: reclaim pages from a suspended process instead of killing it
+    uint32_t pid = create_process("IdleApp", 1, perms, 1);
+    for (uint32_t page = 0; page < 1024; page++) {
+        vm_access(pid, page * PAGE_SIZE, true);
+    }
+    suspend_process(pid);
+
+    uint64_t start = monotonic_ns();
+    uint32_t reclaimed = reclaim_pages(512);
+    uint64_t elapsed = monotonic_ns() - start;
+    printf("Reclaimed %u pages from IdleApp in %llu us, %u pages still resident\n",
+           reclaimed, (unsigned long long)(elapsed / 1000), virtual_memory.spaces[pid - 1].resident_pages);
+    terminate_process(pid);
+}
+
+// Launch 100 apps from scratch and from a zygote, compare latency and memory
+void benchmark_zygote_launch() {
+    const int launch_count = 100;
+    const uint32_t framework_pages = 384;   // Shared runtime every app initializes
+    const uint32_t private_pages = 16;      // App heap
+    const uint32_t dirtied_pages = 16;      // Framework pages an app writes to
+    uint32_t pids[100];
+    AppPermission perms[] = {PERM_NETWORK, PERM_STORAGE};
+    static LatencyHistogram launches;
+
+    printf("\nZygote benchmark: %d app launches, %u framework pages each\n", launch_count, framework_pages);
+    printf("%-10s %10s %10s %10s %12s\n", "mode", "avg_us", "p50_us", "p99_us", "resident_MB");
+
+    for (int use_zygote = 0; use_zygote <= 1; use_zygote++) {
+        uint32_t zygote = 0;
+        uint32_t free_before = virtual_memory.free_count;
+        memset(&launches, 0, sizeof(LatencyHistogram));
+
+        if (use_zygote) {
+            zygote = create_zygote("zygote", framework_pages);
+        }
+
+        for (int i = 0; i < launch_count; i++) {
+            char name[32];
+            sprintf(name, "App%d", i);
+            uint64_t start = monotonic_ns();
+
+            if (use_zygote) {
+                pids[i] = fork_from_zygote(zygote, name, 4, perms, 2);
+            } else {
+                // Cold start: the app initializes the framework itself
+                pids[i] = create_process(name, 4, perms, 2);
+                for (uint32_t page = 0; page < framework_pages; page++) {
+                    vm_access(pids[i], ZYGOTE_PRELOAD_BASE + page * PAGE_SIZE, true);
+                }
+            }
+
+            for (uint32_t page = 0; page < dirtied_pages; page++) {
+                vm_access(pids[i], ZYGOTE_PRELOAD_BASE + page * 7 * PAGE_SIZE, true);
+            }
+            for (uint32_t page = 0; page < private_pages; page++) {
+                vm_access(pids[i], 0x20000000 + page * PAGE_SIZE, true);
+            }
+
+            uint64_t elapsed_us = (monotonic_ns() - start) / 1000;
+            histogram_record(&launches, elapsed_us);
+        }
+
+        uint32_t used_pages = free_before - virtual_memory.free_count;
+        printf("%-10s %10llu %10llu %10llu %12.1f\n",
+               use_zygote ? "zygote" : "cold",
+               (unsigned long long)(launches.sum / launches.count),
+               (unsigned long long)histogram_percentile(&launches, 50.0),
+               (unsigned long long)histogram_percentile(&launches, 99.0),
+               used_pages * (double)PAGE_SIZE / (1024 * 1024));
+
+        for (int i = 0; i < launch_count; i++) {
+            terminate_process(pids[i]);
+        }
+        terminate_process(zygote);
+    }
+}
+
+// Sensor consumers against foreground and background load on one CPU
+// Compares plain priorities, the deadline class, and the deadline class with priority inheritance
+typedef struct {
+    const char* name;
+    uint8_t priority;
+    bool sensor_consumer;    // Deadline class candidate
+    uint32_t work_us;        // Per job, also the reserved runtime
+    uint32_t period_us;
+    uint32_t deadline_us;
+    uint32_t lock_us;        // Work done holding the shared sensor buffer at the start of a job
+} MixedLoadTask;
+
+void benchmark_deadline_scheduling() {
+    const MixedLoadTask load[] = {
+        {"NavigationApp",  8, true,  1000, 10000, 10000, 200},
+        {"AccelConsumer",  8, true,   500,  4000,  2000, 100},
+        {"CameraApp",      9, false, 5000, 16000, 16000,   0},
+        {"MediaDecoder",   5, false, 3000, 12000, 12000,   0},
+        {"BackgroundTask", 2, false, 4000, 20000, 20000, 1000}
+    };
+    const int task_count = sizeof(load) / sizeof(load[0]);
+    const char* modes[] = {"priority", "deadline", "deadline+pi"};
+    const uint32_t tick_us = 50;
+    const uint64_t duration_us = 2000000;
+    static LatencyHistogram responses;
+    AppPermission perms[] = {PERM_SENSORS, PERM_LOCATION};
+
+    printf("\nDeadline scheduling benchmark: %d tasks on one CPU for 2 s\n", task_count);
+    printf("%-12s %6s %7s %9s %9s %9s\n", "mode", "jobs", "misses", "p50_us", "p99_us", "max_us");
+
+    for (int mode = 0; mode < 3; mode++) {
+        uint32_t pids[8];
+        uint32_t remaining[8] = {0};
+        uint32_t lock_left[8] = {0};
+        uint64_t release[8] = {0};
+        uint64_t next_release[8] = {0};
+        bool holding[8] = {false};
+        bool blocked[8] = {false};
+        uint32_t misses = 0;
+        KernelMutex sensor_buffer = {0};
+        sensor_buffer.priority_inheritance = mode == 2;
+        memset(&responses, 0, sizeof(LatencyHistogram));
+
+        for (int t = 0; t < task_count; t++) {
+            pids[t] = create_process(load[t].name, load[t].priority, perms, 2);
+            mobile_kernel.processes[pids[t] - 1].cpu = 0;
+            if (mode > 0 && load[t].sensor_consumer) {
+                set_deadline_scheduling(pids[t], load[t].work_us, load[t].period_us, load[t].deadline_us);
+            }
+        }
+
+        for (uint64_t now = 0; now < duration_us; now += tick_us) {
+            bool runnable[MAX_PROCESSES] = {false};
+
+            for (int t = 0; t < task_count; t++) {
+                if (now < next_release[t]) continue;
+
+                if (load[t].sensor_consumer) {
+                    // Newer sensor data supersedes an unfinished job
+                    if (remaining[t] > 0) {
+                        uint64_t response = now - release[t];
+                        histogram_record(&responses, response);
+                        misses++;
+                    }
+                    remaining[t] = load[t].work_us;
+                    if (mobile_kernel.processes[pids[t] - 1].sched_class == SCHED_CLASS_DEADLINE) {
+                        deadline_release_job(pids[t], now);
+                    }
+                } else {
+                    remaining[t] += load[t].work_us; // Backlog carries over
+                }
+                if (!holding[t]) {
+                    lock_left[t] = load[t].lock_us;
+                }
+                release[t] = now;
+                next_release[t] += load[t].period_us;
+            }
+
+            for (int t = 0; t < task_count; t++) {
+                runnable[pids[t] - 1] = remaining[t] > 0 && !blocked[t];
+            }
+
+            // Pick a task, tasks that block on the sensor buffer drop out and we pick again
+            int running = -1;
+            while (running < 0) {
+                uint32_t pid = pick_next_task(0, runnable);
+                if (pid == 0) break;
+                int t = 0;
+                while (pids[t] != pid) t++;
+
+                if (lock_left[t] > 0 && !holding[t] && !kernel_mutex_lock(&sensor_buffer, pid)) {
+                    blocked[t] = true;
+                    runnable[pid - 1] = false;
+                    continue;
+                }
+                if (lock_left[t] > 0) holding[t] = true;
+                running = t;
+            }
+            if (running < 0) continue;
+
+            uint32_t ran = remaining[running] < tick_us ? remaining[running] : tick_us;
+            remaining[running] -= ran;
+            scheduler_account(pids[running], ran);
+
+            if (holding[running]) {
+                lock_left[running] = lock_left[running] > ran ? lock_left[running] - ran : 0;
+                if (lock_left[running] == 0) {
+                    holding[running] = false;
+                    uint32_t next_owner = kernel_mutex_unlock(&sensor_buffer);
+                    for (int t = 0; t < task_count; t++) {
+                        if (pids[t] == next_owner) {
+                            holding[t] = true;
+                            blocked[t] = false;
+                        }
+                    }
+                }
+            }
+
+            if (remaining[running] == 0 && load[running].sensor_consumer) {
+                uint64_t response = now + tick_us - release[running];
+                histogram_record(&responses, response);
+                if (response > load[running].deadline_us) misses++;
+            }
+        }
+
+        printf("%-12s %6llu %7u %9llu %9llu %9llu\n",
+               modes[mode],
+               (unsigned long long)responses.count,
+               misses,
+               (unsigned long long)histogram_percentile(&responses, 50.0),
+               (unsigned long long)histogram_percentile(&responses, 99.0),
+               (unsigned long long)responses.max);
+
+        for (int t = 0; t < task_count; t++) {
+            terminate_process(pids[t]);
+        }
+    }
+
+    // Admission control: 90% reservations, one more than there are CPUs
+    uint32_t admitted = 0;
+    uint32_t heavy[MAX_CPUS + 1];
+    for (int i = 0; i <= MAX_CPUS; i++) {
+        heavy[i] = create_process("HeavyRT", 5, perms, 1);
+        if (set_deadline_scheduling(heavy[i], 9000, 10000, 10000)) {
+            admitted++;
+        }
+    }
+    printf("Admission control: %u of %d reservations at 90%% admitted on %d CPUs\n", admitted, MAX_CPUS + 1, MAX_CPUS);
+    for (int i = 0; i <= MAX_CPUS; i++) {
+        terminate_process(heavy[i]);
+    }
+}
+
+// Foreground random reads against a background app streaming sequential writes
+void benchmark_storage_io() {
+    const char* modes[] = {"fg only", "fg+bg fifo", "fg+bg deadline"};
+    const IoSchedulerPolicy policies[] = {IO_SCHED_DEADLINE, IO_SCHED_FIFO, IO_SCHED_DEADLINE};
+    const uint64_t duration_us = 200000;
+    const uint32_t tick_us = 50;
+    const uint32_t read_interval_us = 250;        // 4000 foreground reads per second
+    const uint32_t background_depth = 64;         // Writes the background app keeps outstanding
+    static uint8_t scratch[IO_BLOCK_SIZE];
+    static LatencyHistogram latency[IO_CLASS_COUNT];
+    AppPermission fg_perms[] = {PERM_STORAGE, PERM_CAMERA};
+    AppPermission bg_perms[] = {PERM_STORAGE, PERM_BACKGROUND_PROCESS};
+
+    printf("\nStorage I/O benchmark: 4 KB requests for 200 ms on a %d channel device\n", IO_QUEUE_DEPTH);
+    printf("%-15s %8s %8s %8s %8s %8s %8s %9s\n",
+           "mode", "fg_iops", "fg_p50", "fg_p99", "bg_iops", "bg_p50", "bg_p99", "commands");
+
+    for (int mode = 0; mode < 3; mode++) {
+        uint32_t seed = 2024;
+        uint32_t fg_pid = create_process("GalleryApp", 8, fg_perms, 2);
+        uint32_t bg_pid = create_process("BackupTask", 2, bg_perms, 2);
+        uint32_t bg_outstanding = 0;
+        uint32_t bg_block = 0;
+        uint64_t commands = metrics_counter_total(COUNTER_IO_COMMANDS);
+        IoCompletion completion;
+
+        storage_init(IO_BACKING_FILE, policies[mode]);
+        memset(latency, 0, sizeof(latency));
+
+        for (uint64_t now = 0; now < duration_us; now += tick_us) {
+            io_advance(now);
+            while (io_reap(&completion)) {
+                histogram_record(&latency[completion.pid == fg_pid ? IO_CLASS_FOREGROUND : IO_CLASS_BACKGROUND],
+                                 completion.latency_us);
+                if (completion.pid == bg_pid) bg_outstanding--;
+            }
+
+            if (now % read_interval_us == 0) {
+                seed = seed * 1103515245 + 12345;
+                io_submit(fg_pid, IO_READ, (seed >> 8) % IO_DEVICE_BLOCKS, 1, scratch);
+            }
+            while (mode > 0 && bg_outstanding < background_depth &&
+                   io_submit(bg_pid, IO_WRITE, bg_block, 1, scratch)) {
+                bg_block = (bg_block + 1) % IO_DEVICE_BLOCKS;
+                bg_outstanding++;
+            }
+        }
+        commands = metrics_counter_total(COUNTER_IO_COMMANDS) - commands;
+
+        printf("%-15s %8llu %8llu %8llu %8llu %8llu %8llu %9llu\n", modes[mode],
+               (unsigned long long)(latency[IO_CLASS_FOREGROUND].count * 1000000 / duration_us),
+               (unsigned long long)histogram_percentile(&latency[IO_CLASS_FOREGROUND], 50.0),
+               (unsigned long long)histogram_percentile(&latency[IO_CLASS_FOREGROUND], 99.0),
+               (unsigned long long)(latency[IO_CLASS_BACKGROUND].count * 1000000 / duration_us),
+               (unsigned long long)histogram_percentile(&latency[IO_CLASS_BACKGROUND], 50.0),
+               (unsigned long long)histogram_percentile(&latency[IO_CLASS_BACKGROUND], 99.0),
+               (unsigned long long)commands);
+
+        terminate_process(fg_pid);
+        terminate_process(bg_pid);
+    }
+
+    storage_init(IO_BACKING_FILE, IO_SCHED_DEADLINE);
+}
+
+// Token minting and verification rates during an app launch storm
+void benchmark_security_tokens() {
+    const uint32_t operations = 1000000;
+    const int app_count = 100;
+    const uint32_t forged_count = 4096;
+    AppPermission perms[] = {PERM_NETWORK};
+    uint32_t pids[100];
+    uint8_t token[SECURITY_TOKEN_LENGTH];
+    uint8_t (*forged)[SECURITY_TOKEN_LENGTH] = malloc(forged_count * SECURITY_TOKEN_LENGTH);
+    uint32_t issued = 0;
+    uint32_t valid_accepted = 0;
+    uint32_t forged_accepted = 0;
+    uint64_t elapsed[4];
+
+    if (forged == NULL) {
+        return;
+    }
+    printf("\nSecurity token benchmark: %u operations each, %d apps holding tokens\n", operations, app_count);
+
+    // Raw generator output, the old byte at a time rand() against ChaCha20
+    uint64_t start = monotonic_ns();
+    for (uint32_t i = 0; i < operations; i++) {
+        for (int b = 0; b < SECURITY_TOKEN_LENGTH; b++) {
+            token[b] = rand() % 256;
+        }
+    }
+    elapsed[0] = monotonic_ns() - start;
+
+    start = monotonic_ns();
+    for (uint32_t i = 0; i < operations; i++) {
+        csprng_fill(token, SECURITY_TOKEN_LENGTH);
+    }
+    elapsed[1] = monotonic_ns() - start;
+
+    for (int i = 0; i < app_count; i++) {
+        pids[i] = create_process("LaunchStormApp", 5, perms, 1);
+    }
+
+    // Full mint path: revoke the old token, draw a new one, stamp it and insert it in the table
+    start = monotonic_ns();
+    for (uint32_t i = 0; i < operations; i++) {
+        uint32_t pid = pids[i % app_count];
+        token_revoke(pid);
+        issued += token_issue(pid);
+    }
+    elapsed[2] = monotonic_ns() - start;
+    uint32_t now = system_time();
+
+    start = monotonic_ns();
+    for (uint32_t i = 0; i < operations; i++) {
+        uint32_t pid = pids[i % app_count];
+        valid_accepted += token_verify(mobile_kernel.processes[pid - 1].security_token.token, now) == pid;
+    }
+    elapsed[3] = monotonic_ns() - start;
+
+    // Forged tokens are random values that were never issued, drawn before the clock starts
+    for (uint32_t i = 0; i < forged_count; i++) {
+        csprng_fill(forged[i], SECURITY_TOKEN_LENGTH);
+    }
+    start = monotonic_ns();
+    for (uint32_t i = 0; i < operations; i++) {
+        forged_accepted += token_verify(forged[i % forged_count], now) != 0;
+    }
+    uint64_t forged_elapsed = monotonic_ns() - start;
+
+    const char* names[] = {"rand() 32 B", "chacha20 32 B", "issue+revoke", "verify valid", "verify forged"};
+    printf("%-15s %12s %10s\n", "operation", "ops_per_sec", "ns_per_op");
+    for (int i = 0; i < 5; i++) {
+        uint64_t ns = i < 4 ? elapsed[i] : forged_elapsed;
+        printf("%-15s %12.0f %10.1f\n", names[i], operations * 1e9 / (ns ? ns : 1), (double)ns / operations);
+    }
+    printf("Tokens issued: %u of %u, valid accepted: %u, forged accepted: %u\n",
+           issued, operations, valid_accepted, forged_accepted);
+
+    uint32_t creation = mobile_kernel.processes[pids[0] - 1].security_token.creation_time;
+    printf("Token after %d s: %s\n", TOKEN_LIFETIME_SECONDS,
+           token_verify(mobile_kernel.processes[pids[0] - 1].security_token.token,
+                        creation + TOKEN_LIFETIME_SECONDS) ? "accepted" : "expired");
+
+    for (int i = 0; i < app_count; i++) {
+        terminate_process(pids[i]);
+    }
+    free(forged);
+}
+
+// Dump the proc-style kernel statistics
+void print_kernel_stats() {
+    const char* entries[] = {"meminfo", "vmstat", "schedstat", "sensorstat", "cpufreq", "diskstats", "latency"};
+    char buffer[PROC_BUFFER_SIZE];
+
+    for (int i = 0; i < 7; i++) {
+        kernel_proc_read(entries[i], buffer, sizeof(buffer));
+        printf("\n/proc/%s\n%s", entries[i], buffer);
+    }
+}
+
 // Kernel Initialization
 void initialize_mobile_os() {
     // Initialize kernel state
     memset(&mobile_kernel, 0, sizeof(MobileOSKernel));
+    memset(&kernel_metrics, 0, sizeof(KernelMetrics));
+    memset(&kernel_events, 0, sizeof(KernelEventQueue));
+    current_cpu = 0;
     
     // Set initial power state
     mobile_kernel.current_power_mode = POWER_FULL;
@@ -307,9 +3683,28 @@ void initialize_mobile_os() {
     // Initialize total and available memory
     mobile_kernel.total_memory = 256 * 1024 * 1024;  // 256 MB
     mobile_kernel.available_memory = mobile_kernel.total_memory;
+    metrics_gauge_set(GAUGE_AVAILABLE_MEMORY, mobile_kernel.available_memory);
+
+    // Set up the physical frame pool
+    vm_init();
+
+    // Start the utilization driven CPU governor
+    governor_init(GOVERNOR_SCHEDUTIL);
+
+    // Coalesce background jobs into maintenance windows
+    job_scheduler_init(true);
+
+    // Open the backing store for block I/O
+    if (!storage_init(IO_BACKING_FILE, IO_SCHED_DEADLINE)) {
+        printf("Storage backing file %s unavailable\n", IO_BACKING_FILE);
+    }
     
     // Generate initial security token
+    memset(token_table, 0, sizeof(token_table));
     generate_security_token();
+    if (!mobile_kernel.system_token.is_valid) {
+        printf("No entropy source, security tokens unavailable\n");
+    }
 }
 
 // Main function -----------------------------------------------------------------------------
@@ -325,14 +3720,62 @@ int main() {
     // Create processes
     create_multiple_processes();
 
+    // Subscribe apps to sensors, CameraApp lacks PERM_SENSORS and is refused
+    uint32_t navigation_gps = sensor_subscribe(1, SENSOR_GPS, 1);
+    uint32_t navigation_motion = sensor_subscribe(1, SENSOR_ACCELEROMETER, 25);
+    uint32_t camera_light = sensor_subscribe(2, SENSOR_LIGHT, 10);
+    printf("Sensor subscriptions: GPS %s, Accelerometer %s, Light %s\n",
+           navigation_gps ? "granted" : "denied",
+           navigation_motion ? "granted" : "denied",
+           camera_light ? "granted" : "denied");
+
     // Simulate sensor activity
     simulate_sensor_activity();
 
+    // Asynchronous storage I/O
+    simulate_storage_activity();
+
     // Test scheduler
     simulate_scheduler();
 
     // Test power state transitions
     test_power_state_transitions();
+
+    // Exercise the allocator and dump kernel statistics
+    for (int i = 0; i < 64; i++) {
+        adaptive_memory_allocation(4096);
+    }
+    print_kernel_stats();
+
+    // Check the front-end event stream
+    test_event_stream_reconstruction();
+
+    // Sensor data fan-out to several subscribers
+    test_sensor_fanout();
+
+    // Deadline tasks run from the scheduler pass
+    test_deadline_release();
+
+    // Compare CPU governor policies
+    benchmark_governor_policies();
+
+    // Compare background job wakeups with and without coalescing
+    benchmark_job_coalescing();
+
+    // Page fault and TLB behaviour for different access patterns
+    benchmark_virtual_memory();
+
+    // App launch from scratch versus from a zygote
+    benchmark_zygote_launch();
+
+    // Sensor consumer deadlines under mixed load
+    benchmark_deadline_scheduling();
+
+    // Foreground storage latency under background write load
+    benchmark_storage_io();
+
+    // Token minting and verification throughput
+    benchmark_security_tokens();
     
     while (1) {
         // Continuous kernel maintenance
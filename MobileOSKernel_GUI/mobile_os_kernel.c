@@ -3,6 +3,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
+#include <stdarg.h>
 #include <windows.h>
 #include <time.h>
 
@@ -11,6 +12,14 @@
 #define MAX_APP_PERMISSIONS 8
 #define SECURITY_TOKEN_LENGTH 32
 #define MAX_LOG_ENTRIES 100
+#define MAX_CPUS 4
+#define PROC_BUFFER_SIZE 2048
+#define EVENT_QUEUE_SIZE 256
+
+// Latency histograms: 8 linear sub-buckets per power of two (HDR-style, ~12% precision)
+#define HIST_SUB_BUCKET_BITS 3
+#define HIST_SUB_BUCKETS (1 << HIST_SUB_BUCKET_BITS)
+#define HIST_BUCKETS (40 * HIST_SUB_BUCKETS)
 
 // Advanced Power Management States
 typedef enum {
@@ -80,12 +89,104 @@ typedef struct {
     uint32_t available_memory;
 } MobileOSKernel;
 
+// Metric Counters (per CPU)
+typedef enum {
+    COUNTER_PROCESSES_CREATED,
+    COUNTER_PROCESS_CREATE_FAILED,
+    COUNTER_MEMORY_ALLOCATIONS,
+    COUNTER_MEMORY_ALLOC_FAILED,
+    COUNTER_MEMORY_RECLAIMS,
+    COUNTER_POWER_TRANSITIONS,
+    COUNTER_SCHEDULER_PASSES,
+    COUNTER_CONTEXT_SWITCHES,
+    COUNTER_SENSOR_SAMPLES,
+    METRIC_COUNTER_COUNT
+} MetricCounter;
+
+// Metric Gauges (system wide)
+typedef enum {
+    GAUGE_AVAILABLE_MEMORY,
+    GAUGE_ACTIVE_SENSORS,
+    GAUGE_RUNNABLE_TASKS,
+    METRIC_GAUGE_COUNT
+} MetricGauge;
+
+// Hot-path Latency Histograms
+typedef enum {
+    HIST_MEMORY_ALLOCATION,
+    HIST_PROCESS_CREATE,
+    HIST_POWER_MANAGEMENT,
+    HIST_SCHEDULER_PASS,
+    METRIC_HIST_COUNT
+} MetricHistogram;
+
+typedef struct {
+    uint64_t buckets[HIST_BUCKETS];
+    uint64_t count;
+    uint64_t sum;             // Same unit as the recorded values, ns for kernel metrics
+    uint64_t max;
+} LatencyHistogram;
+
+// Kernel Metrics Registry
+// Each CPU only writes its own slots, readers sum them, so no lock is needed
+typedef struct {
+    uint64_t counters[MAX_CPUS][METRIC_COUNTER_COUNT];
+    LatencyHistogram histograms[MAX_CPUS][METRIC_HIST_COUNT];
+    int64_t gauges[METRIC_GAUGE_COUNT];
+} KernelMetrics;
+
+// Kernel State-change Events
+typedef enum {
+    EVENT_PROCESS_CREATED,
+    EVENT_PROCESS_EXITED,
+    EVENT_PRIORITY_CHANGED,
+    EVENT_POWER_STATE_CHANGED,
+    EVENT_SENSOR_ADDED,
+    EVENT_SENSOR_RATE_CHANGED,
+    EVENT_POWER_MODE_CHANGED,
+    EVENT_RESYNC // Subscriber fell behind, rebuild from a full scan
+} KernelEventType;
+
+typedef struct {
+    KernelEventType type;
+    uint32_t sequence;
+    uint32_t id;              // PID or sensor slot
+    uint32_t value;           // Priority, power state, sampling rate or power mode
+    SensorType sensor_type;   // EVENT_SENSOR_ADDED only
+    char process_name[32];    // EVENT_PROCESS_CREATED only
+} KernelEvent;
+
+// Bounded Event Queue
+// The kernel never blocks on slow subscribers: old events are overwritten
+// and a subscriber that missed them gets EVENT_RESYNC instead
+typedef struct {
+    KernelEvent events[EVENT_QUEUE_SIZE];
+    uint32_t write_sequence; // Total events ever published
+} KernelEventQueue;
+
+// Per-subscriber read cursor
+typedef struct {
+    uint32_t read_sequence;
+} EventSubscriber;
+
 // Global log buffer for simulation output
 char log_buffer[MAX_LOG_ENTRIES][256];
 int log_count = 0;
+int log_displayed = 0; // Entries already added to the log window
 
 // Existing global variables
 static MobileOSKernel mobile_kernel;
+static KernelMetrics kernel_metrics;
+static KernelEventQueue kernel_events;
+static EventSubscriber gui_subscriber;
+static uint8_t current_cpu; // CPU the simulated kernel is currently running on
+
+static const char* histogram_names[METRIC_HIST_COUNT] = {
+    "memory_allocation",
+    "process_create",
+    "power_management",
+    "scheduler_pass"
+};
 
 // Additional GUI Elements for new functions
 HWND hwndSensorList;
@@ -101,6 +202,7 @@ HWND hwndSchedulerSimulateButton;
 HWND hwndPowerTransitionButton;
 HWND hwndMultiProcessButton;
 HWND hwndMemoryAllocButton;
+HWND hwndKernelStatsButton;
 HWND hwndLogWindow;
 
 // Function Prototypes
@@ -111,18 +213,268 @@ void test_power_state_transitions();
 void create_multiple_processes();
 uint32_t adaptive_memory_allocation(uint32_t requested_size);
 void update_log_display();
+void reset_log();
 
 uint32_t get_system_time() {
     return (uint32_t)time(NULL); // Use Unix timestamp in seconds
 }
 
+// High resolution clock for latency measurements
+uint64_t monotonic_ns() {
+    struct timespec ts;
+#if defined(CLOCK_MONOTONIC)
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+    timespec_get(&ts, TIME_UTC);
+#endif
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Kernel Metrics ----------------------------------------------------------------
+
+static inline void metrics_count(MetricCounter counter, uint64_t delta) {
+    kernel_metrics.counters[current_cpu][counter] += delta;
+}
+
+static inline void metrics_gauge_set(MetricGauge gauge, int64_t value) {
+    kernel_metrics.gauges[gauge] = value;
+}
+
+static inline void metrics_gauge_add(MetricGauge gauge, int64_t delta) {
+    kernel_metrics.gauges[gauge] += delta;
+}
+
+// Map a value onto its log-linear bucket
+static inline uint32_t histogram_bucket(uint64_t value) {
+    if (value < HIST_SUB_BUCKETS) {
+        return (uint32_t)value;
+    }
+    uint32_t shift = 63 - __builtin_clzll(value) - HIST_SUB_BUCKET_BITS;
+    uint32_t index = (shift + 1) * HIST_SUB_BUCKETS + ((value >> shift) & (HIST_SUB_BUCKETS - 1));
+    return index < HIST_BUCKETS ? index : HIST_BUCKETS - 1;
+}
+
+// Smallest value that lands in a bucket
+static uint64_t histogram_bucket_value(uint32_t index) {
+    if (index < HIST_SUB_BUCKETS) {
+        return index;
+    }
+    uint32_t shift = index / HIST_SUB_BUCKETS - 1;
+    return (uint64_t)(HIST_SUB_BUCKETS + index % HIST_SUB_BUCKETS) << shift;
+}
+
+void histogram_record(LatencyHistogram* h, uint64_t value) {
+    h->buckets[histogram_bucket(value)]++;
+    h->count++;
+    h->sum += value;
+    if (value > h->max) {
+        h->max = value;
+    }
+}
+
+void metrics_record_latency(MetricHistogram hist, uint64_t elapsed_ns) {
+    histogram_record(&kernel_metrics.histograms[current_cpu][hist], elapsed_ns);
+}
+
+uint64_t metrics_counter_total(MetricCounter counter) {
+    uint64_t total = 0;
+    for (int cpu = 0; cpu < MAX_CPUS; cpu++) {
+        total += kernel_metrics.counters[cpu][counter];
+    }
+    return total;
+}
+
+// Merge the per-CPU histograms into one snapshot
+void metrics_histogram_snapshot(MetricHistogram hist, LatencyHistogram* out) {
+    memset(out, 0, sizeof(LatencyHistogram));
+    for (int cpu = 0; cpu < MAX_CPUS; cpu++) {
+        const LatencyHistogram* h = &kernel_metrics.histograms[cpu][hist];
+        if (h->count == 0) {
+            continue;
+        }
+        for (int b = 0; b < HIST_BUCKETS; b++) {
+            out->buckets[b] += h->buckets[b];
+        }
+        out->count += h->count;
+        out->sum += h->sum;
+        if (h->max > out->max) {
+            out->max = h->max;
+        }
+    }
+}
+
+uint64_t histogram_percentile(const LatencyHistogram* h, double percentile) {
+    if (h->count == 0) {
+        return 0;
+    }
+    uint64_t target = (uint64_t)(h->count * percentile / 100.0 + 0.999999); // rank, rounded up
+    if (target == 0) {
+        target = 1;
+    }
+    uint64_t seen = 0;
+    for (uint32_t b = 0; b < HIST_BUCKETS; b++) {
+        seen += h->buckets[b];
+        if (seen >= target) {
+            uint64_t value = histogram_bucket_value(b);
+            return value < h->max ? value : h->max;
+        }
+    }
+    return h->max;
+}
+
+// Proc-style Snapshot API ---------------------------------------------------------
+
+static void proc_append(char* buffer, size_t buffer_size, size_t* offset, const char* format, ...) {
+    if (*offset >= buffer_size) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(buffer + *offset, buffer_size - *offset, format, args);
+    va_end(args);
+    if (written > 0) {
+        *offset += (size_t)written;
+        if (*offset >= buffer_size) {
+            *offset = buffer_size - 1;
+        }
+    }
+}
+
+static void proc_meminfo(char* buffer, size_t buffer_size, size_t* offset) {
+    proc_append(buffer, buffer_size, offset, "MemTotal:       %10u kB\n", mobile_kernel.total_memory / 1024);
+    proc_append(buffer, buffer_size, offset, "MemAvailable:   %10lld kB\n",
+                (long long)kernel_metrics.gauges[GAUGE_AVAILABLE_MEMORY] / 1024);
+    proc_append(buffer, buffer_size, offset, "AllocCalls:     %10llu\n",
+                (unsigned long long)metrics_counter_total(COUNTER_MEMORY_ALLOCATIONS));
+    proc_append(buffer, buffer_size, offset, "AllocFailed:    %10llu\n",
+                (unsigned long long)metrics_counter_total(COUNTER_MEMORY_ALLOC_FAILED));
+    proc_append(buffer, buffer_size, offset, "Reclaims:       %10llu\n",
+                (unsigned long long)metrics_counter_total(COUNTER_MEMORY_RECLAIMS));
+}
+
+static void proc_schedstat(char* buffer, size_t buffer_size, size_t* offset) {
+    for (int cpu = 0; cpu < MAX_CPUS; cpu++) {
+        proc_append(buffer, buffer_size, offset, "cpu%d passes %llu switches %llu created %llu\n", cpu,
+                    (unsigned long long)kernel_metrics.counters[cpu][COUNTER_SCHEDULER_PASSES],
+                    (unsigned long long)kernel_metrics.counters[cpu][COUNTER_CONTEXT_SWITCHES],
+                    (unsigned long long)kernel_metrics.counters[cpu][COUNTER_PROCESSES_CREATED]);
+    }
+    proc_append(buffer, buffer_size, offset, "runnable %lld\n", (long long)kernel_metrics.gauges[GAUGE_RUNNABLE_TASKS]);
+    proc_append(buffer, buffer_size, offset, "power_mode %d transitions %llu\n", mobile_kernel.current_power_mode,
+                (unsigned long long)metrics_counter_total(COUNTER_POWER_TRANSITIONS));
+}
+
+static void proc_sensorstat(char* buffer, size_t buffer_size, size_t* offset) {
+    proc_append(buffer, buffer_size, offset, "active %lld samples %llu\n",
+                (long long)kernel_metrics.gauges[GAUGE_ACTIVE_SENSORS],
+                (unsigned long long)metrics_counter_total(COUNTER_SENSOR_SAMPLES));
+    for (int i = 0; i < MAX_SENSORS; i++) {
+        if (mobile_kernel.sensors[i].is_active) {
+            proc_append(buffer, buffer_size, offset, "sensor%d type %d rate %u Hz\n",
+                        i, mobile_kernel.sensors[i].type, mobile_kernel.sensors[i].sampling_rate);
+        }
+    }
+}
+
+static void proc_latency(char* buffer, size_t buffer_size, size_t* offset) {
+    proc_append(buffer, buffer_size, offset, "%-18s %8s %10s %10s %10s %10s\n",
+                "path", "count", "avg_ns", "p50_ns", "p99_ns", "max_ns");
+    for (int hist = 0; hist < METRIC_HIST_COUNT; hist++) {
+        LatencyHistogram snapshot;
+        metrics_histogram_snapshot((MetricHistogram)hist, &snapshot);
+        proc_append(buffer, buffer_size, offset, "%-18s %8llu %10llu %10llu %10llu %10llu\n",
+                    histogram_names[hist],
+                    (unsigned long long)snapshot.count,
+                    (unsigned long long)(snapshot.count ? snapshot.sum / snapshot.count : 0),
+                    (unsigned long long)histogram_percentile(&snapshot, 50.0),
+                    (unsigned long long)histogram_percentile(&snapshot, 99.0),
+                    (unsigned long long)snapshot.max);
+    }
+}
+
+// Read a text snapshot of a kernel entry ("meminfo", "schedstat", "sensorstat", "latency")
+// Returns the number of bytes written, or 0 if the entry does not exist
+size_t kernel_proc_read(const char* entry, char* buffer, size_t buffer_size) {
+    size_t offset = 0;
+    if (buffer_size == 0) {
+        return 0;
+    }
+    buffer[0] = '\0';
+
+    if (strcmp(entry, "meminfo") == 0) {
+        proc_meminfo(buffer, buffer_size, &offset);
+    } else if (strcmp(entry, "schedstat") == 0) {
+        proc_schedstat(buffer, buffer_size, &offset);
+    } else if (strcmp(entry, "sensorstat") == 0) {
+        proc_sensorstat(buffer, buffer_size, &offset);
+    } else if (strcmp(entry, "latency") == 0) {
+        proc_latency(buffer, buffer_size, &offset);
+    }
+    return offset;
+}
+
 // Forward Declarations (Add these at the top)
 void update_gui_state();
 LRESULT CALLBACK WindowProcedure(HWND hwnd, UINT msg, WPARAM wp, LPARAM lp);
 
+// Kernel Event Stream --------------------------------------------------------------
+
+static KernelEvent* event_begin(KernelEventType type, uint32_t id, uint32_t value) {
+    KernelEvent* event = &kernel_events.events[kernel_events.write_sequence % EVENT_QUEUE_SIZE];
+    memset(event, 0, sizeof(KernelEvent));
+    event->type = type;
+    event->sequence = kernel_events.write_sequence;
+    event->id = id;
+    event->value = value;
+    return event;
+}
+
+static inline void event_commit() {
+    kernel_events.write_sequence++;
+}
+
+void publish_event(KernelEventType type, uint32_t id, uint32_t value) {
+    event_begin(type, id, value);
+    event_commit();
+}
+
+// Start receiving events published from now on
+void event_subscribe(EventSubscriber* subscriber) {
+    subscriber->read_sequence = kernel_events.write_sequence;
+}
+
+// Copy up to max_events pending events for a subscriber, returns how many were copied
+uint32_t event_poll(EventSubscriber* subscriber, KernelEvent* out, uint32_t max_events) {
+    uint32_t pending = kernel_events.write_sequence - subscriber->read_sequence;
+    uint32_t copied = 0;
+
+    if (max_events == 0) {
+        return 0;
+    }
+
+    // Missed events were overwritten, the subscriber has to rescan
+    if (pending > EVENT_QUEUE_SIZE) {
+        memset(&out[0], 0, sizeof(KernelEvent));
+        out[0].type = EVENT_RESYNC;
+        out[0].sequence = kernel_events.write_sequence;
+        subscriber->read_sequence = kernel_events.write_sequence;
+        return 1;
+    }
+
+    while (copied < pending && copied < max_events) {
+        out[copied] = kernel_events.events[subscriber->read_sequence % EVENT_QUEUE_SIZE];
+        subscriber->read_sequence++;
+        copied++;
+    }
+    return copied;
+}
+
 // Advanced Power Management
 void update_power_management(PowerManagementState new_state) {
+    uint64_t start = monotonic_ns();
     mobile_kernel.current_power_mode = new_state;
+    metrics_count(COUNTER_POWER_TRANSITIONS, 1);
+    publish_event(EVENT_POWER_MODE_CHANGED, 0, new_state);
     
     switch (new_state) {
         case POWER_FULL:
@@ -135,6 +487,7 @@ void update_power_management(PowerManagementState new_state) {
             for (int i = 0; i < MAX_SENSORS; i++) {
                 if (mobile_kernel.sensors[i].is_active) {
                     mobile_kernel.sensors[i].sampling_rate /= 2;
+                    publish_event(EVENT_SENSOR_RATE_CHANGED, i, mobile_kernel.sensors[i].sampling_rate);
                 }
             }
             break;
@@ -144,6 +497,11 @@ void update_power_management(PowerManagementState new_state) {
             // Disable most sensors
             for (int i = 0; i < MAX_PROCESSES; i++) {
                 if (mobile_kernel.processes[i].priority < 2) {
+                    if (mobile_kernel.processes[i].pid != 0 &&
+                        mobile_kernel.processes[i].power_state != POWER_SUSPEND) {
+                        metrics_gauge_add(GAUGE_RUNNABLE_TASKS, -1);
+                        publish_event(EVENT_POWER_STATE_CHANGED, mobile_kernel.processes[i].pid, POWER_SUSPEND);
+                    }
                     mobile_kernel.processes[i].power_state = POWER_SUSPEND;
                 }
             }
@@ -152,6 +510,8 @@ void update_power_management(PowerManagementState new_state) {
         default:
             break;
     }
+
+    metrics_record_latency(HIST_POWER_MANAGEMENT, monotonic_ns() - start);
 }
 
 // Enhanced Sensor Management
@@ -164,6 +524,11 @@ bool register_sensor(SensorType type, uint16_t sampling_rate) {
             
             // Allocate sensor data buffer
             mobile_kernel.sensors[i].data_buffer = malloc(1024);
+            metrics_gauge_add(GAUGE_ACTIVE_SENSORS, 1);
+
+            KernelEvent* event = event_begin(EVENT_SENSOR_ADDED, i, sampling_rate);
+            event->sensor_type = type;
+            event_commit();
             
             return true;
         }
@@ -178,6 +543,9 @@ uint32_t create_enhanced_process(
     AppPermission* required_permissions,
     uint8_t permission_count
 ) {
+    uint64_t start = monotonic_ns();
+    uint32_t pid = 0;
+
     for (int i = 0; i < MAX_PROCESSES; i++) {
         if (mobile_kernel.processes[i].pid == 0) {
             // Initialize process
@@ -191,16 +559,35 @@ uint32_t create_enhanced_process(
                 mobile_kernel.processes[i].permissions[required_permissions[j]] = true;
             }
             
-            return mobile_kernel.processes[i].pid;
+            pid = mobile_kernel.processes[i].pid;
+            break;
+        }
+    }
+
+    if (pid != 0) {
+        EnhancedProcessControlBlock* process = &mobile_kernel.processes[pid - 1];
+        metrics_count(COUNTER_PROCESSES_CREATED, 1);
+        if (process->power_state != POWER_SUSPEND) {
+            metrics_gauge_add(GAUGE_RUNNABLE_TASKS, 1);
+        }
+
+        KernelEvent* event = event_begin(EVENT_PROCESS_CREATED, pid, priority);
+        memcpy(event->process_name, process->process_name, sizeof(event->process_name));
+        event_commit();
+        if (process->power_state != POWER_FULL) {
+            publish_event(EVENT_POWER_STATE_CHANGED, pid, process->power_state);
         }
+    } else {
+        metrics_count(COUNTER_PROCESS_CREATE_FAILED, 1); // Process creation failed
     }
-    return 0; // Process creation failed
+    metrics_record_latency(HIST_PROCESS_CREATE, monotonic_ns() - start);
+    return pid;
 }
 
 // Security Token Generation
 void generate_security_token() {
     // Reset log for this simulation
-    log_count = 0;
+    reset_log();
 
     // In a real implementation, use cryptographically secure random generation
     for (int i = 0; i < SECURITY_TOKEN_LENGTH; i++) {
@@ -217,12 +604,14 @@ void generate_security_token() {
 
     sprintf(token_log, "Token Validity: %s", mobile_kernel.system_token.is_valid ? "Valid" : "Invalid");
     strcpy(log_buffer[log_count++], token_log);
+
+    update_log_display();
 }
 
 // Simulate sensor activity
 void simulate_sensor_activity() {
     // Reset log for this simulation
-    log_count = 0;
+    reset_log();
 
     for (int i = 0; i < MAX_SENSORS; i++) {
         if (mobile_kernel.sensors[i].is_active) {
@@ -231,6 +620,7 @@ void simulate_sensor_activity() {
             for (int j = 0; j < 10; j++) {  // Simulating 10 readings
                 data[j] = rand() % 100;  // Random values between 0 and 99
             }
+            metrics_count(COUNTER_SENSOR_SAMPLES, 10);
 
             // Log sensor simulation details
             char sensor_log[256];
@@ -250,12 +640,17 @@ void simulate_sensor_activity() {
 // Process Scheduler Simulation
 void simulate_scheduler() {
     // Reset log for this simulation
-    log_count = 0;
+    reset_log();
 
     strcpy(log_buffer[log_count++], "Simulating process scheduler...");
+    uint64_t start = monotonic_ns();
 
     for (int i = 0; i < MAX_PROCESSES; i++) {
         if (mobile_kernel.processes[i].pid != 0) {
+            // Spread processes across the simulated CPUs
+            current_cpu = i % MAX_CPUS;
+            metrics_count(COUNTER_CONTEXT_SWITCHES, 1);
+
             char process_log[256];
             sprintf(process_log, "Running Process PID: %u, Name: %s, Priority: %u",
                    mobile_kernel.processes[i].pid,
@@ -268,13 +663,17 @@ void simulate_scheduler() {
         }
     }
 
+    current_cpu = 0;
+    metrics_count(COUNTER_SCHEDULER_PASSES, 1);
+    metrics_record_latency(HIST_SCHEDULER_PASS, monotonic_ns() - start);
+
     update_log_display();
 }
 
 // Power State Transition Test
 void test_power_state_transitions() {
     // Reset log for this simulation
-    log_count = 0;
+    reset_log();
 
     char power_log[256];
     sprintf(power_log, "Current Power Mode: %d", mobile_kernel.current_power_mode);
@@ -316,7 +715,7 @@ void test_power_state_transitions() {
 // Create Multiple Processes
 void create_multiple_processes() {
     // Reset log for this simulation
-    log_count = 0;
+    reset_log();
 
     AppPermission perms1[] = {PERM_LOCATION, PERM_NETWORK};
     create_enhanced_process("NavigationApp", 8, perms1, 2);
@@ -344,9 +743,9 @@ void create_multiple_processes() {
 }
 
 // Adaptive Memory Allocation
-uint32_t adaptive_memory_allocation(uint32_t requested_size) {
+static uint32_t allocate_memory(uint32_t requested_size) {
     // Reset log for this simulation
-    log_count = 0;
+    reset_log();
 
     char mem_log[256];
     sprintf(mem_log, "Requested Memory Size: %u bytes", requested_size);
@@ -379,15 +778,72 @@ uint32_t adaptive_memory_allocation(uint32_t requested_size) {
     return 0;
 }
 
-void update_gui_state() {
+uint32_t adaptive_memory_allocation(uint32_t requested_size) {
+    uint64_t start = monotonic_ns();
+    uint32_t address = allocate_memory(requested_size);
+
+    metrics_count(address != 0 ? COUNTER_MEMORY_ALLOCATIONS : COUNTER_MEMORY_ALLOC_FAILED, 1);
+    metrics_gauge_set(GAUGE_AVAILABLE_MEMORY, mobile_kernel.available_memory);
+    metrics_record_latency(HIST_MEMORY_ALLOCATION, monotonic_ns() - start);
+    return address;
+}
+
+// Poll the proc-style kernel statistics into the log window
+void show_kernel_stats() {
+    const char* entries[] = {"meminfo", "schedstat", "sensorstat", "latency"};
+    char buffer[PROC_BUFFER_SIZE];
+
+    // Reset log for this snapshot
+    reset_log();
+
+    for (int i = 0; i < 4 && log_count < MAX_LOG_ENTRIES; i++) {
+        kernel_proc_read(entries[i], buffer, sizeof(buffer));
+        sprintf(log_buffer[log_count++], "/proc/%s", entries[i]);
+
+        // One log entry per line of the snapshot
+        char* line = strtok(buffer, "\n");
+        while (line != NULL && log_count < MAX_LOG_ENTRIES) {
+            snprintf(log_buffer[log_count++], sizeof(log_buffer[0]), "  %s", line);
+            line = strtok(NULL, "\n");
+        }
+    }
+
+    update_log_display();
+}
+
+static void format_sensor_entry(char* buffer, int slot) {
+    sprintf(buffer, "Sensor %d: Type %d, Rate: %u Hz",
+            slot, mobile_kernel.sensors[slot].type, mobile_kernel.sensors[slot].sampling_rate);
+}
+
+static void format_process_entry(char* buffer, uint32_t pid) {
+    sprintf(buffer, "PID %u: %s (Priority %u)",
+            pid,
+            mobile_kernel.processes[pid - 1].process_name,
+            mobile_kernel.processes[pid - 1].priority);
+}
+
+// Replace (or remove when text is NULL) the listbox entry starting with prefix
+static void listbox_replace(HWND list, const char* prefix, const char* text) {
+    LRESULT index = SendMessage(list, LB_FINDSTRING, (WPARAM)-1, (LPARAM)prefix);
+    if (index == LB_ERR) {
+        return;
+    }
+    SendMessage(list, LB_DELETESTRING, (WPARAM)index, 0);
+    if (text != NULL) {
+        SendMessage(list, LB_INSERTSTRING, (WPARAM)index, (LPARAM)text);
+    }
+}
+
+// Full rescan, only needed when the GUI fell behind the event queue
+void rebuild_gui_state() {
     char buffer[256];
 
     // Clear and repopulate sensor list
     SendMessage(hwndSensorList, LB_RESETCONTENT, 0, 0);
     for (int i = 0; i < MAX_SENSORS; i++) {
         if (mobile_kernel.sensors[i].is_active) {
-            sprintf(buffer, "Sensor %d: Type %d, Rate: %u Hz", 
-                    i, mobile_kernel.sensors[i].type, mobile_kernel.sensors[i].sampling_rate);
+            format_sensor_entry(buffer, i);
             SendMessage(hwndSensorList, LB_ADDSTRING, 0, (LPARAM)buffer);
         }
     }
@@ -396,10 +852,7 @@ void update_gui_state() {
     SendMessage(hwndProcessList, LB_RESETCONTENT, 0, 0);
     for (int i = 0; i < MAX_PROCESSES; i++) {
         if (mobile_kernel.processes[i].pid != 0) {
-            sprintf(buffer, "PID %u: %s (Priority %u)", 
-                    mobile_kernel.processes[i].pid, 
-                    mobile_kernel.processes[i].process_name, 
-                    mobile_kernel.processes[i].priority);
+            format_process_entry(buffer, mobile_kernel.processes[i].pid);
             SendMessage(hwndProcessList, LB_ADDSTRING, 0, (LPARAM)buffer);
         }
     }
@@ -409,14 +862,78 @@ void update_gui_state() {
     SetWindowText(hwndPowerMode, buffer);
 }
 
+// Apply one kernel event to the widgets
+void apply_gui_event(const KernelEvent* event) {
+    char prefix[32];
+    char buffer[256];
+
+    switch (event->type) {
+        case EVENT_PROCESS_CREATED:
+            format_process_entry(buffer, event->id);
+            SendMessage(hwndProcessList, LB_ADDSTRING, 0, (LPARAM)buffer);
+            break;
+
+        case EVENT_PROCESS_EXITED:
+            sprintf(prefix, "PID %u:", event->id);
+            listbox_replace(hwndProcessList, prefix, NULL);
+            break;
+
+        case EVENT_PRIORITY_CHANGED:
+            sprintf(prefix, "PID %u:", event->id);
+            format_process_entry(buffer, event->id);
+            listbox_replace(hwndProcessList, prefix, buffer);
+            break;
+
+        case EVENT_SENSOR_ADDED:
+            format_sensor_entry(buffer, event->id);
+            SendMessage(hwndSensorList, LB_ADDSTRING, 0, (LPARAM)buffer);
+            break;
+
+        case EVENT_SENSOR_RATE_CHANGED:
+            sprintf(prefix, "Sensor %u:", event->id);
+            format_sensor_entry(buffer, event->id);
+            listbox_replace(hwndSensorList, prefix, buffer);
+            break;
+
+        case EVENT_POWER_MODE_CHANGED:
+            sprintf(buffer, "Current Power Mode: %u", event->value);
+            SetWindowText(hwndPowerMode, buffer);
+            break;
+
+        case EVENT_RESYNC:
+            rebuild_gui_state();
+            break;
+
+        default:
+            // Process power states are not shown in the GUI
+            break;
+    }
+}
+
+// Drain pending kernel events into the widgets
+void update_gui_state() {
+    KernelEvent batch[32];
+    uint32_t count;
+
+    while ((count = event_poll(&gui_subscriber, batch, 32)) > 0) {
+        for (uint32_t i = 0; i < count; i++) {
+            apply_gui_event(&batch[i]);
+        }
+    }
+}
+
+// Start a fresh log for the next simulation
+void reset_log() {
+    log_count = 0;
+    log_displayed = 0;
+    SendMessage(hwndLogWindow, LB_RESETCONTENT, 0, 0);
+}
+
 // Update log display function
 void update_log_display() {
-    // Clear existing log
-    SendMessage(hwndLogWindow, LB_RESETCONTENT, 0, 0);
-    
-    // Add log entries
-    for (int i = 0; i < log_count; i++) {
-        SendMessage(hwndLogWindow, LB_ADDSTRING, 0, (LPARAM)log_buffer[i]);
+    // Add only the entries written since the last update
+    for (; log_displayed < log_count; log_displayed++) {
+        SendMessage(hwndLogWindow, LB_ADDSTRING, 0, (LPARAM)log_buffer[log_displayed]);
     }
 }
 
@@ -445,11 +962,14 @@ LRESULT CALLBACK WindowProcedure(HWND hwnd, UINT msg, WPARAM wp, LPARAM lp) {
             simulate_scheduler();
         } else if ((HWND)lp == hwndPowerTransitionButton) {
             test_power_state_transitions();
+            update_gui_state();
         } else if ((HWND)lp == hwndMultiProcessButton) {
             create_multiple_processes();
         } else if ((HWND)lp == hwndMemoryAllocButton) {
             // Simulate memory allocation of 1024 bytes
             adaptive_memory_allocation(1024);
+        } else if ((HWND)lp == hwndKernelStatsButton) {
+            show_kernel_stats();
         }
         break;
     case WM_DESTROY:
@@ -488,6 +1008,7 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
     hwndPowerTransitionButton = CreateWindow("BUTTON", "Power Transitions", WS_CHILD | WS_VISIBLE, 560, 350, 150, 30, hwnd, NULL, hInstance, NULL);
     hwndMultiProcessButton = CreateWindow("BUTTON", "Create Processes", WS_CHILD | WS_VISIBLE, 740, 350, 150, 30, hwnd, NULL, hInstance, NULL);
     hwndMemoryAllocButton = CreateWindow("BUTTON", "Memory Alloc", WS_CHILD | WS_VISIBLE, 20, 400, 150, 30, hwnd, NULL, hInstance, NULL);
+    hwndKernelStatsButton = CreateWindow("BUTTON", "Kernel Stats", WS_CHILD | WS_VISIBLE, 200, 400, 150, 30, hwnd, NULL, hInstance, NULL);
     
     // Log Window for Simulation Output
     hwndLogWindow = CreateWindow("LISTBOX", NULL, WS_CHILD | WS_VISIBLE | WS_VSCROLL | LBS_NOSEL,  20, 450, 960, 250, hwnd, NULL, hInstance, NULL);
@@ -504,8 +1025,13 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 
     // Initialize the kernel state
     memset(&mobile_kernel, 0, sizeof(MobileOSKernel));
+    memset(&kernel_metrics, 0, sizeof(KernelMetrics));
+    memset(&kernel_events, 0, sizeof(KernelEventQueue));
     mobile_kernel.current_power_mode = POWER_FULL;
 
+    // Subscribe before the initial setup so it arrives as events
+    event_subscribe(&gui_subscriber);
+
     // Optional: Add some initial setup
     register_sensor(SENSOR_ACCELEROMETER, 50);
     register_sensor(SENSOR_GPS, 10);
@@ -529,4 +1055,4 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 // main function as a fallback for some compilers
 int main(int argc, char *argv[]) {
     return WinMain(GetModuleHandle(NULL), NULL, GetCommandLineA(), SW_SHOW);
-}
\ No newline at end of file
+}